@@ -1,3 +1,7 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "cpandas.h"
 
 #include <inttypes.h>
@@ -5,9 +9,132 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#ifdef CPANDAS_HAVE_OPENMP
+#include <omp.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#define BENCH_HAVE_POSIX 1
+#else
+#define BENCH_HAVE_POSIX 0
+#endif
+
+#define BENCH_MAX_THREADS 16
+#define BENCH_MAX_RESULTS 256
+#define BENCH_NESTED_MAX_ROWS ((size_t)20000)
+
+typedef struct {
+  size_t rows;
+  size_t warmup;
+  size_t reps;
+  size_t threads[BENCH_MAX_THREADS];
+  size_t thread_count;
+  size_t cardinality;
+  CpJoinStrategy join_strategy;
+  int join_all;
+  double match_rate;
+  double key_dup_rate;
+  int json;
+  const char *dir;
+} BenchOptions;
+
+typedef struct {
+  char bench[32];
+  char params[96];
+  size_t threads;
+  size_t rows;
+  size_t out_rows;
+  double bytes;
+  double min_s;
+  double median_s;
+  double mean_s;
+  size_t peak_rss;
+} BenchResult;
+
+/* One timed case. run() performs the measured operation on prepared input;
+   rows and bytes describe the work of a single run. */
+typedef struct BenchCase {
+  const char *bench;
+  char params[96];
+  const CpDataFrame *df;
+  const CpDataFrame *other;
+  const char *path;
+  const char *key;
+  CpJoinStrategy strategy;
+  size_t rows;
+  double bytes;
+  size_t out_rows;
+  uint8_t *mask;
+  int (*run)(struct BenchCase *bc, CpError *err);
+} BenchCase;
+
+static BenchResult bench_results[BENCH_MAX_RESULTS];
+static size_t bench_result_count = 0;
+
+static double now_seconds(void) {
+  struct timespec ts;
+#if BENCH_HAVE_POSIX
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+  timespec_get(&ts, TIME_UTC);
+#endif
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static size_t peak_rss_bytes(void) {
+#if BENCH_HAVE_POSIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return (size_t)usage.ru_maxrss;
+#else
+  return (size_t)usage.ru_maxrss * 1024u;
+#endif
+#else
+  return 0;
+#endif
+}
+
+static size_t default_threads(void) {
+#ifdef CPANDAS_HAVE_OPENMP
+  return (size_t)omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+static void set_threads(size_t threads) {
+#ifdef CPANDAS_HAVE_OPENMP
+  omp_set_num_threads((int)threads);
+#else
+  (void)threads;
+#endif
+}
 
-static double elapsed_seconds(clock_t start, clock_t end) {
-  return (double)(end - start) / (double)CLOCKS_PER_SEC;
+static long file_size(const char *path) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    return 0;
+  }
+  long size = 0;
+  if (fseek(fp, 0, SEEK_END) == 0) {
+    size = ftell(fp);
+  }
+  fclose(fp);
+  return size < 0 ? 0 : size;
+}
+
+static double frame_bytes(const CpDataFrame *df) {
+  size_t total = 0;
+  CpError err;
+  cp_error_clear(&err);
+  if (!cp_df_memory_usage(df, 1, NULL, 0, &total, &err)) {
+    return 0.0;
+  }
+  return (double)total;
 }
 
 static const char *strategy_name(CpJoinStrategy strategy) {
@@ -20,6 +147,8 @@ static const char *strategy_name(CpJoinStrategy strategy) {
       return "hash";
     case CP_JOIN_STRATEGY_SORTED:
       return "sorted";
+    case CP_JOIN_STRATEGY_PARTITIONED_HASH:
+      return "partitioned";
     default:
       return "unknown";
   }
@@ -48,6 +177,10 @@ static int parse_join_strategy(const char *value,
     *out_strategy = CP_JOIN_STRATEGY_SORTED;
     return 1;
   }
+  if (strcmp(value, "partitioned") == 0) {
+    *out_strategy = CP_JOIN_STRATEGY_PARTITIONED_HASH;
+    return 1;
+  }
   if (strcmp(value, "all") == 0) {
     *out_strategy = CP_JOIN_STRATEGY_AUTO;
     *out_all = 1;
@@ -56,264 +189,785 @@ static int parse_join_strategy(const char *value,
   return 0;
 }
 
-static void print_usage(const char *prog) {
-  fprintf(stderr,
-          "Usage: %s [rows] [--join] [--strategy auto|nested|hash|sorted|all] "
-          "[--match-rate 0-1] [--key-dup-rate 0-1]\n",
-          prog);
+static int parse_size(const char *value, size_t *out, int allow_zero) {
+  char *end = NULL;
+  unsigned long long parsed = strtoull(value, &end, 10);
+  if (!end || end == value || *end != '\0' || (!allow_zero && parsed == 0)) {
+    return 0;
+  }
+  *out = (size_t)parsed;
+  return 1;
 }
 
-int main(int argc, char **argv) {
-  size_t rows = 200000;
-  int run_join = 0;
-  CpJoinStrategy join_strategy = CP_JOIN_STRATEGY_AUTO;
-  int join_all = 0;
-  double match_rate = 1.0;
-  double key_dup_rate = 0.0;
-  for (int i = 1; i < argc; ++i) {
-    const char *arg = argv[i];
-    if (strcmp(arg, "--join") == 0) {
-      run_join = 1;
-      continue;
-    }
-    if (strcmp(arg, "--strategy") == 0 || strcmp(arg, "--join-strategy") == 0) {
-      if (i + 1 >= argc) {
-        print_usage(argv[0]);
-        return 1;
-      }
-      int parsed_all = 0;
-      if (!parse_join_strategy(argv[i + 1], &join_strategy, &parsed_all)) {
-        print_usage(argv[0]);
-        return 1;
-      }
-      join_all = parsed_all;
-      run_join = 1;
-      i += 1;
-      continue;
-    }
-    if (strcmp(arg, "--match-rate") == 0) {
-      if (i + 1 >= argc) {
-        print_usage(argv[0]);
-        return 1;
-      }
-      char *end = NULL;
-      double parsed = strtod(argv[i + 1], &end);
-      if (!end || *end != '\0' || parsed < 0.0 || parsed > 1.0) {
-        print_usage(argv[0]);
-        return 1;
-      }
-      match_rate = parsed;
-      run_join = 1;
-      i += 1;
-      continue;
-    }
-    if (strcmp(arg, "--key-dup-rate") == 0) {
-      if (i + 1 >= argc) {
-        print_usage(argv[0]);
-        return 1;
-      }
-      char *end = NULL;
-      double parsed = strtod(argv[i + 1], &end);
-      if (!end || *end != '\0' || parsed < 0.0 || parsed > 1.0) {
-        print_usage(argv[0]);
-        return 1;
-      }
-      key_dup_rate = parsed;
-      run_join = 1;
-      i += 1;
-      continue;
-    }
-    if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
-      print_usage(argv[0]);
-      return 0;
-    }
-    if (arg[0] == '-') {
-      print_usage(argv[0]);
-      return 1;
-    }
-    char *end = NULL;
-    unsigned long long parsed = strtoull(arg, &end, 10);
-    if (!end || *end != '\0' || parsed == 0) {
-      print_usage(argv[0]);
-      return 1;
-    }
-    rows = (size_t)parsed;
+static int parse_rate(const char *value, double *out) {
+  char *end = NULL;
+  double parsed = strtod(value, &end);
+  if (!end || end == value || *end != '\0' || parsed < 0.0 || parsed > 1.0) {
+    return 0;
   }
+  *out = parsed;
+  return 1;
+}
 
-  const char *names[] = {"id", "value", "label"};
-  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_STRING};
-  CpError err;
-  cp_error_clear(&err);
-
-  if (!run_join) {
-    CpDataFrame *df = cp_df_create(3, names, dtypes, rows, &err);
-    if (!df) {
-      fprintf(stderr, "failed to create dataframe: %s\n", err.message);
-      return 1;
+static int parse_thread_list(const char *value, BenchOptions *opts) {
+  opts->thread_count = 0;
+  const char *cursor = value;
+  while (*cursor) {
+    char *end = NULL;
+    unsigned long long parsed = strtoull(cursor, &end, 10);
+    if (end == cursor || parsed == 0 ||
+        opts->thread_count == BENCH_MAX_THREADS) {
+      return 0;
     }
-
-    clock_t start = clock();
-    for (size_t i = 0; i < rows; ++i) {
-      char id_buf[32];
-      char val_buf[64];
-      snprintf(id_buf, sizeof(id_buf), "%zu", i + 1);
-      snprintf(val_buf, sizeof(val_buf), "%.3f", (double)i * 0.5);
-      const char *row[] = {id_buf, val_buf, "alpha"};
-      if (!cp_df_append_row(df, row, 3, &err)) {
-        fprintf(stderr, "append failed at row %zu: %s\n", i, err.message);
-        cp_df_free(df);
-        return 1;
-      }
+    opts->threads[opts->thread_count++] = (size_t)parsed;
+    if (*end == ',') {
+      ++end;
+    } else if (*end != '\0') {
+      return 0;
     }
-    clock_t end = clock();
-    double append_s = elapsed_seconds(start, end);
+    cursor = end;
+  }
+  return opts->thread_count > 0;
+}
 
-    const CpSeries *id_series = cp_df_get_col(df, "id");
-    const CpSeries *val_series = cp_df_get_col(df, "value");
+static void print_usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [bench] [rows] [options]\n"
+          "  bench: all, append, csv-read, csv-write, parquet-read,\n"
+          "         parquet-write, cpd-read, cpd-write, sort, groupby, query,\n"
+          "         pivot, resample, rolling, join, kernels (default append)\n"
+          "  --rows N               input rows (default 200000)\n"
+          "  --warmup N             untimed runs per case (default 1)\n"
+          "  --reps N               timed runs per case (default 5)\n"
+          "  --threads 1,2,4        OpenMP thread sweep (default: runtime)\n"
+          "  --cardinality N        groupby/pivot key count (default sweep)\n"
+          "  --strategy auto|nested|hash|sorted|partitioned|all\n"
+          "  --match-rate 0-1       join right-side match rate\n"
+          "  --key-dup-rate 0-1     join duplicate-key rate\n"
+          "  --dir PATH             directory for temporary files (default .)\n"
+          "  --json                 emit JSON instead of a table\n"
+          "  --join, --groupby, --kernels select a bench (legacy flags)\n",
+          prog);
+}
 
-    int64_t isum = 0;
-    double fsum = 0.0;
-    size_t count = 0;
-    size_t nulls = 0;
+static uint32_t xorshift32(uint32_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
 
-    start = clock();
-    if (!cp_series_sum_int64(id_series, &isum, &count, &nulls, &err)) {
-      fprintf(stderr, "sum int failed: %s\n", err.message);
-    }
-    if (!cp_series_sum_float64(val_series, &fsum, &count, &nulls, &err)) {
-      fprintf(stderr, "sum float failed: %s\n", err.message);
+/* Mixed-type frame shared by most cases: a unique id, a random int64 key and
+   its string form, a 4-value side label, an epoch-second timestamp, and two
+   measures. */
+static CpDataFrame *make_table(size_t rows, size_t cardinality, CpError *err) {
+  const char *names[] = {"id", "key", "sym", "side", "ts", "qty", "price"};
+  CpDType dtypes[] = {CP_DTYPE_INT64,  CP_DTYPE_INT64, CP_DTYPE_STRING,
+                      CP_DTYPE_STRING, CP_DTYPE_INT64, CP_DTYPE_INT64,
+                      CP_DTYPE_FLOAT64};
+  const char *sides[] = {"bid", "ask", "buy", "sell"};
+  CpDataFrame *df = cp_df_create(7, names, dtypes, rows, err);
+  if (!df) {
+    return NULL;
+  }
+  if (cardinality == 0 || cardinality > rows) {
+    cardinality = rows;
+  }
+  uint32_t state = 2463534242u;
+  for (size_t i = 0; i < rows; ++i) {
+    size_t key = (size_t)xorshift32(&state) % cardinality;
+    char id_buf[32];
+    char key_buf[32];
+    char sym_buf[32];
+    char ts_buf[32];
+    char qty_buf[32];
+    char price_buf[64];
+    snprintf(id_buf, sizeof(id_buf), "%zu", i);
+    snprintf(key_buf, sizeof(key_buf), "%zu", key);
+    snprintf(sym_buf, sizeof(sym_buf), "SYM%zu", key);
+    snprintf(ts_buf, sizeof(ts_buf), "%zu", 1600000000u + i * 3u);
+    snprintf(qty_buf, sizeof(qty_buf), "%zu", i % 100);
+    snprintf(price_buf, sizeof(price_buf), "%.2f", (double)(i % 1000) * 0.25);
+    const char *row[] = {id_buf, key_buf, sym_buf, sides[key % 4],
+                         ts_buf, qty_buf, price_buf};
+    if (!cp_df_append_row(df, row, 7, err)) {
+      cp_df_free(df);
+      return NULL;
     }
-    end = clock();
-    double sum_s = elapsed_seconds(start, end);
-
-    printf("rows: %zu\n", rows);
-    printf("append: %.4fs (%.0f rows/s)\n", append_s,
-           append_s > 0.0 ? (double)rows / append_s : 0.0);
-    printf("sum: %.6fs\n", sum_s);
-    printf("checksum int: %" PRId64 ", float: %.3f\n", isum, fsum);
-
-    cp_df_free(df);
-    return 0;
   }
+  return df;
+}
 
-  size_t join_rows = rows;
-  if ((join_all || join_strategy == CP_JOIN_STRATEGY_NESTED) &&
-      join_rows > 20000) {
-    join_rows = 20000;
-    printf("join rows capped at %zu for nested strategy\n", join_rows);
-  }
-  size_t match_rows = (size_t)((double)join_rows * match_rate);
+static int make_join_frames(const BenchOptions *opts,
+                            size_t join_rows,
+                            CpDataFrame **out_left,
+                            CpDataFrame **out_right,
+                            CpError *err) {
+  size_t match_rows = (size_t)((double)join_rows * opts->match_rate);
   if (match_rows > join_rows) {
     match_rows = join_rows;
   }
-  size_t dup_rows = (size_t)((double)match_rows * key_dup_rate);
+  size_t dup_rows = (size_t)((double)match_rows * opts->key_dup_rate);
   if (dup_rows > match_rows) {
     dup_rows = match_rows;
   }
   size_t unique_match_rows = match_rows - dup_rows;
   if (match_rows > 0 && unique_match_rows == 0) {
     unique_match_rows = 1;
-    dup_rows = match_rows - 1;
   }
 
-  const char *join_left_names[] = {"id", "left_val"};
-  const char *join_right_names[] = {"id", "right_val"};
-  CpDType join_types[] = {CP_DTYPE_INT64, CP_DTYPE_INT64};
-
-  CpDataFrame *left = cp_df_create(2, join_left_names, join_types, join_rows, &err);
-  if (!left) {
-    fprintf(stderr, "failed to create left join dataframe: %s\n", err.message);
-    return 1;
-  }
-  CpDataFrame *right = cp_df_create(2, join_right_names, join_types, join_rows, &err);
-  if (!right) {
-    fprintf(stderr, "failed to create right join dataframe: %s\n", err.message);
+  const char *left_names[] = {"id", "left_val"};
+  const char *right_names[] = {"id", "right_val"};
+  CpDType types[] = {CP_DTYPE_INT64, CP_DTYPE_INT64};
+  CpDataFrame *left = cp_df_create(2, left_names, types, join_rows, err);
+  CpDataFrame *right = cp_df_create(2, right_names, types, join_rows, err);
+  if (!left || !right) {
     cp_df_free(left);
-    return 1;
+    cp_df_free(right);
+    return 0;
   }
-
   for (size_t i = 0; i < join_rows; ++i) {
     char id_buf[32];
     char val_buf[32];
     snprintf(id_buf, sizeof(id_buf), "%zu", i);
     snprintf(val_buf, sizeof(val_buf), "%zu", i * 2);
     const char *row[] = {id_buf, val_buf};
-    if (!cp_df_append_row(left, row, 2, &err)) {
-      fprintf(stderr, "left append failed at row %zu: %s\n", i, err.message);
+    if (!cp_df_append_row(left, row, 2, err)) {
       cp_df_free(left);
       cp_df_free(right);
-      return 1;
+      return 0;
     }
   }
-
   for (size_t i = 0; i < join_rows; ++i) {
-    char id_buf[32];
-    char val_buf[32];
     size_t key = 0;
     if (i < match_rows) {
-      if (i < unique_match_rows) {
-        key = i;
-      } else {
-        size_t base = i - unique_match_rows;
-        key = unique_match_rows > 0 ? (base % unique_match_rows) : 0;
-      }
+      key = i < unique_match_rows ? i : (i - unique_match_rows) %
+                                            unique_match_rows;
     } else {
       key = join_rows + (i - match_rows);
     }
+    char id_buf[32];
+    char val_buf[32];
     snprintf(id_buf, sizeof(id_buf), "%zu", key);
     snprintf(val_buf, sizeof(val_buf), "%zu", i * 3);
     const char *row[] = {id_buf, val_buf};
-    if (!cp_df_append_row(right, row, 2, &err)) {
-      fprintf(stderr, "right append failed at row %zu: %s\n", i, err.message);
+    if (!cp_df_append_row(right, row, 2, err)) {
       cp_df_free(left);
       cp_df_free(right);
-      return 1;
+      return 0;
+    }
+  }
+  *out_left = left;
+  *out_right = right;
+  return 1;
+}
+
+static int finish_frame(BenchCase *bc, CpDataFrame *out) {
+  if (!out) {
+    return 0;
+  }
+  bc->out_rows = cp_df_nrows(out);
+  cp_df_free(out);
+  return 1;
+}
+
+static const CpDType table_dtypes[] = {CP_DTYPE_INT64,  CP_DTYPE_INT64,
+                                       CP_DTYPE_STRING, CP_DTYPE_STRING,
+                                       CP_DTYPE_INT64,  CP_DTYPE_INT64,
+                                       CP_DTYPE_FLOAT64};
+
+static int run_csv_read(BenchCase *bc, CpError *err) {
+  return finish_frame(bc, cp_df_read_csv_parallel(bc->path, ',', 1,
+                                                  table_dtypes, 7, NULL, 0, 0,
+                                                  err));
+}
+
+static int run_csv_write(BenchCase *bc, CpError *err) {
+  bc->out_rows = bc->rows;
+  return cp_df_write_csv(bc->df, bc->path, ',', 1, err);
+}
+
+static int run_parquet_read(BenchCase *bc, CpError *err) {
+  return finish_frame(bc, cp_df_read_parquet(bc->path, err));
+}
+
+static int run_parquet_write(BenchCase *bc, CpError *err) {
+  bc->out_rows = bc->rows;
+  return cp_df_write_parquet(bc->df, bc->path, err);
+}
+
+static int run_cpd_read(BenchCase *bc, CpError *err) {
+  return finish_frame(bc, cp_df_read_cpd(bc->path, err));
+}
+
+static int run_cpd_write(BenchCase *bc, CpError *err) {
+  bc->out_rows = bc->rows;
+  return cp_df_write_cpd(bc->df, bc->path, err);
+}
+
+static int run_sort(BenchCase *bc, CpError *err) {
+  return finish_frame(bc, cp_df_sort_values(bc->df, bc->key, 1, err));
+}
+
+static int run_groupby(BenchCase *bc, CpError *err) {
+  const char *value_cols[] = {"qty", "price", "price"};
+  CpAggOp ops[] = {CP_AGG_SUM, CP_AGG_MEAN, CP_AGG_MAX};
+  return finish_frame(
+      bc, cp_df_groupby_agg(bc->df, bc->key, value_cols, ops, 3, err));
+}
+
+static int run_query(BenchCase *bc, CpError *err) {
+  return finish_frame(
+      bc, cp_df_query(bc->df, "qty >= 50 and (price < 100 or side == \"ask\")",
+                      err));
+}
+
+static int run_pivot(BenchCase *bc, CpError *err) {
+  return finish_frame(bc, cp_df_pivot_table(bc->df, bc->key, "side", "price",
+                                            CP_AGG_SUM, err));
+}
+
+static int run_resample(BenchCase *bc, CpError *err) {
+  const char *value_cols[] = {"price", "qty"};
+  CpAggOp ops[] = {CP_AGG_MEAN, CP_AGG_SUM};
+  return finish_frame(
+      bc, cp_df_resample(bc->df, "ts", 60, value_cols, ops, 2, err));
+}
+
+static int run_rolling(BenchCase *bc, CpError *err) {
+  const char *value_cols[] = {"price", "price", "qty"};
+  CpRollingOp ops[] = {CP_ROLLING_MEAN, CP_ROLLING_STD, CP_ROLLING_MAX};
+  return finish_frame(bc, cp_df_rolling(bc->df, NULL, 100, 0, 0, value_cols,
+                                        ops, 3, err));
+}
+
+static int run_join(BenchCase *bc, CpError *err) {
+  return finish_frame(bc, cp_df_join_with_strategy(bc->df, bc->other, "id",
+                                                   "id", CP_JOIN_INNER,
+                                                   bc->strategy, err));
+}
+
+static int run_append(BenchCase *bc, CpError *err) {
+  const char *names[] = {"id", "value", "label"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_STRING};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, bc->rows, err);
+  if (!df) {
+    return 0;
+  }
+  for (size_t i = 0; i < bc->rows; ++i) {
+    char id_buf[32];
+    char val_buf[64];
+    snprintf(id_buf, sizeof(id_buf), "%zu", i + 1);
+    snprintf(val_buf, sizeof(val_buf), "%.3f", (double)i * 0.5);
+    const char *row[] = {id_buf, val_buf, "alpha"};
+    if (!cp_df_append_row(df, row, 3, err)) {
+      cp_df_free(df);
+      return 0;
     }
   }
+  return finish_frame(bc, df);
+}
+
+static int run_kernel(BenchCase *bc, CpError *err) {
+  const CpSeries *a = cp_df_get_col(bc->df, "key");
+  const CpSeries *x = cp_df_get_col(bc->df, "price");
+  int64_t ival = 0;
+  double fval = 0.0;
+  size_t count = 0;
+  size_t nulls = 0;
+  bc->out_rows = bc->rows;
+  if (strcmp(bc->key, "sum_int64") == 0) {
+    return cp_series_sum_int64(a, &ival, &count, &nulls, err);
+  }
+  if (strcmp(bc->key, "min_int64") == 0) {
+    return cp_series_min_int64(a, &ival, &nulls, err);
+  }
+  if (strcmp(bc->key, "max_int64") == 0) {
+    return cp_series_max_int64(a, &ival, &nulls, err);
+  }
+  if (strcmp(bc->key, "sum_float64") == 0) {
+    return cp_series_sum_float64(x, &fval, &count, &nulls, err);
+  }
+  if (strcmp(bc->key, "mask_int64") == 0) {
+    return cp_df_mask_int64(bc->df, "key", CP_OP_GT, 50000, bc->mask,
+                            bc->rows, err);
+  }
+  if (strcmp(bc->key, "mask_float64") == 0) {
+    return cp_df_mask_float64(bc->df, "price", CP_OP_LE, 100.0, bc->mask,
+                              bc->rows, err);
+  }
+  if (strcmp(bc->key, "mask_cols_int64") == 0) {
+    return cp_df_mask_cols(bc->df, "key", CP_OP_LT, "qty", bc->mask, bc->rows,
+                           err);
+  }
+  return cp_df_mask_cols(bc->df, "price", CP_OP_GE, "qty", bc->mask, bc->rows,
+                         err);
+}
 
-  printf("join rows: %zu\n", join_rows);
-  printf("match rate: %.2f (match rows: %zu)\n", match_rate, match_rows);
-  printf("key dup rate: %.2f (unique keys: %zu, dup rows: %zu)\n",
-         key_dup_rate,
-         unique_match_rows,
-         dup_rows);
+static int compare_doubles(const void *a, const void *b) {
+  double lhs = *(const double *)a;
+  double rhs = *(const double *)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
 
+/* Runs warmup + reps iterations of a case at every sweep thread count and
+   records one result per thread count. */
+static int measure_case(BenchCase *bc, const BenchOptions *opts) {
+  double *times = (double *)malloc(opts->reps * sizeof(double));
+  if (!times) {
+    fprintf(stderr, "%s: out of memory\n", bc->bench);
+    return 0;
+  }
+  int ok = 1;
+  for (size_t t = 0; ok && t < opts->thread_count; ++t) {
+    size_t threads = opts->threads[t];
+    set_threads(threads);
+    CpError err;
+    cp_error_clear(&err);
+    for (size_t r = 0; ok && r < opts->warmup; ++r) {
+      ok = bc->run(bc, &err);
+    }
+    for (size_t r = 0; ok && r < opts->reps; ++r) {
+      double start = now_seconds();
+      ok = bc->run(bc, &err);
+      times[r] = now_seconds() - start;
+    }
+    if (!ok) {
+      fprintf(stderr, "%s (%s) failed: %s\n", bc->bench, bc->params,
+              err.message);
+      break;
+    }
+    if (bench_result_count == BENCH_MAX_RESULTS) {
+      fprintf(stderr, "too many benchmark results\n");
+      ok = 0;
+      break;
+    }
+    double sum = 0.0;
+    for (size_t r = 0; r < opts->reps; ++r) {
+      sum += times[r];
+    }
+    qsort(times, opts->reps, sizeof(double), compare_doubles);
+    BenchResult *res = &bench_results[bench_result_count++];
+    memset(res, 0, sizeof(*res));
+    snprintf(res->bench, sizeof(res->bench), "%s", bc->bench);
+    snprintf(res->params, sizeof(res->params), "%s", bc->params);
+    res->threads = threads;
+    res->rows = bc->rows;
+    res->out_rows = bc->out_rows;
+    res->bytes = bc->bytes > 0.0 ? bc->bytes
+                                 : (bc->path ? (double)file_size(bc->path) : 0);
+    res->min_s = times[0];
+    res->mean_s = sum / (double)opts->reps;
+    res->median_s = opts->reps % 2
+                        ? times[opts->reps / 2]
+                        : 0.5 * (times[opts->reps / 2 - 1] +
+                                 times[opts->reps / 2]);
+    res->peak_rss = peak_rss_bytes();
+  }
+  free(times);
+  return ok;
+}
+
+static void temp_path(char *out, size_t len, const BenchOptions *opts,
+                      const char *ext) {
+#if BENCH_HAVE_POSIX
+  long tag = (long)getpid();
+#else
+  long tag = (long)time(NULL);
+#endif
+  snprintf(out, len, "%s/cpandas_bench_%ld.%s", opts->dir, tag, ext);
+}
+
+static int bench_file(const char *kind,
+                      const CpDataFrame *table,
+                      const BenchOptions *opts) {
+  char path[1024];
+  BenchCase bc;
+  memset(&bc, 0, sizeof(bc));
+  bc.df = table;
+  bc.rows = cp_df_nrows(table);
+  bc.path = path;
+  snprintf(bc.params, sizeof(bc.params), "cols=7");
+  CpError err;
+  cp_error_clear(&err);
+  int wrote = 0;
+  int reading = strstr(kind, "-read") != NULL;
+  if (strncmp(kind, "csv", 3) == 0) {
+    temp_path(path, sizeof(path), opts, "csv");
+    bc.run = reading ? run_csv_read : run_csv_write;
+    wrote = !reading || cp_df_write_csv(table, path, ',', 1, &err);
+  } else if (strncmp(kind, "parquet", 7) == 0) {
+    temp_path(path, sizeof(path), opts, "parquet");
+    bc.run = reading ? run_parquet_read : run_parquet_write;
+    wrote = !reading || cp_df_write_parquet(table, path, &err);
+  } else {
+    temp_path(path, sizeof(path), opts, "cpd");
+    bc.run = reading ? run_cpd_read : run_cpd_write;
+    wrote = !reading || cp_df_write_cpd(table, path, &err);
+  }
+  bc.bench = kind;
+  if (!wrote) {
+    fprintf(stderr, "%s setup failed: %s\n", kind, err.message);
+    remove(path);
+    return 0;
+  }
+  int ok = measure_case(&bc, opts);
+  remove(path);
+  return ok;
+}
+
+static int bench_frame_op(const char *bench,
+                          const char *key,
+                          const CpDataFrame *table,
+                          size_t cardinality,
+                          int (*run)(BenchCase *, CpError *),
+                          const BenchOptions *opts) {
+  BenchCase bc;
+  memset(&bc, 0, sizeof(bc));
+  bc.bench = bench;
+  bc.df = table;
+  bc.key = key;
+  bc.rows = cp_df_nrows(table);
+  bc.bytes = frame_bytes(table);
+  bc.run = run;
+  if (key) {
+    snprintf(bc.params, sizeof(bc.params), "key=%s,cardinality=%zu", key,
+             cardinality);
+  } else {
+    snprintf(bc.params, sizeof(bc.params), "cardinality=%zu", cardinality);
+  }
+  return measure_case(&bc, opts);
+}
+
+static int bench_groupby(const BenchOptions *opts,
+                         CpDataFrame *table,
+                         size_t table_cardinality) {
+  size_t sweep[] = {16, 1024, 65536, 0};
+  size_t sweep_count = 4;
+  if (opts->cardinality > 0) {
+    sweep[0] = opts->cardinality;
+    sweep_count = 1;
+  }
+  int ok = 1;
+  size_t prev_keys = 0;
+  for (size_t s = 0; ok && s < sweep_count; ++s) {
+    size_t keys = sweep[s] == 0 || sweep[s] > opts->rows ? opts->rows
+                                                         : sweep[s];
+    if (keys == prev_keys) {
+      continue;
+    }
+    prev_keys = keys;
+    CpDataFrame *df = table;
+    if (keys != table_cardinality) {
+      CpError err;
+      cp_error_clear(&err);
+      df = make_table(opts->rows, keys, &err);
+      if (!df) {
+        fprintf(stderr, "groupby setup failed: %s\n", err.message);
+        return 0;
+      }
+    }
+    ok = bench_frame_op("groupby", "key", df, keys, run_groupby, opts) &&
+         bench_frame_op("groupby", "sym", df, keys, run_groupby, opts);
+    if (df != table) {
+      cp_df_free(df);
+    }
+  }
+  return ok;
+}
+
+static int bench_join(const BenchOptions *opts) {
+  size_t join_rows = opts->rows;
+  if ((opts->join_all || opts->join_strategy == CP_JOIN_STRATEGY_NESTED) &&
+      join_rows > BENCH_NESTED_MAX_ROWS) {
+    join_rows = BENCH_NESTED_MAX_ROWS;
+    fprintf(stderr, "join rows capped at %zu for nested strategy\n",
+            join_rows);
+  }
+  CpDataFrame *left = NULL;
+  CpDataFrame *right = NULL;
+  CpError err;
+  cp_error_clear(&err);
+  if (!make_join_frames(opts, join_rows, &left, &right, &err)) {
+    fprintf(stderr, "join setup failed: %s\n", err.message);
+    return 0;
+  }
   CpJoinStrategy strategies[] = {CP_JOIN_STRATEGY_NESTED,
                                  CP_JOIN_STRATEGY_SORTED,
                                  CP_JOIN_STRATEGY_HASH,
+                                 CP_JOIN_STRATEGY_PARTITIONED_HASH,
                                  CP_JOIN_STRATEGY_AUTO};
-  size_t strategy_count = join_all ? 4 : 1;
-
-  printf("%-10s %10s %12s %10s\n", "strategy", "seconds", "rows/s", "out_rows");
-  printf("%-10s %10s %12s %10s\n", "----------", "----------", "------------",
-         "----------");
-  for (size_t i = 0; i < strategy_count; ++i) {
-    CpJoinStrategy strategy = join_all ? strategies[i] : join_strategy;
-    clock_t start = clock();
-    CpDataFrame *joined =
-        cp_df_join_with_strategy(left,
-                                 right,
-                                 "id",
-                                 "id",
-                                 CP_JOIN_INNER,
-                                 strategy,
-                                 &err);
-    clock_t end = clock();
-    double join_s = elapsed_seconds(start, end);
-    if (!joined) {
-      fprintf(stderr, "join failed (%s): %s\n", strategy_name(strategy), err.message);
-      continue;
-    }
-    size_t out_rows = cp_df_nrows(joined);
-    printf("%-10s %10.4f %12.0f %10zu\n",
-           strategy_name(strategy),
-           join_s,
-           join_s > 0.0 ? (double)join_rows / join_s : 0.0,
-           out_rows);
-    cp_df_free(joined);
+  size_t strategy_count = opts->join_all ? 5 : 1;
+  int ok = 1;
+  for (size_t i = 0; ok && i < strategy_count; ++i) {
+    BenchCase bc;
+    memset(&bc, 0, sizeof(bc));
+    bc.bench = "join";
+    bc.df = left;
+    bc.other = right;
+    bc.strategy = opts->join_all ? strategies[i] : opts->join_strategy;
+    bc.rows = cp_df_nrows(left) + cp_df_nrows(right);
+    bc.bytes = frame_bytes(left) + frame_bytes(right);
+    bc.run = run_join;
+    snprintf(bc.params, sizeof(bc.params),
+             "strategy=%s,match=%.2f,dup=%.2f", strategy_name(bc.strategy),
+             opts->match_rate, opts->key_dup_rate);
+    ok = measure_case(&bc, opts);
   }
-
   cp_df_free(left);
   cp_df_free(right);
+  return ok;
+}
+
+static int bench_kernels(const CpDataFrame *table, const BenchOptions *opts) {
+  const char *kernels[] = {"sum_int64",       "min_int64",
+                           "max_int64",       "sum_float64",
+                           "mask_int64",      "mask_float64",
+                           "mask_cols_int64", "mask_cols_float64"};
+  double bytes_per_row[] = {8.0, 8.0, 8.0, 8.0, 9.0, 9.0, 17.0, 17.0};
+  size_t rows = cp_df_nrows(table);
+  uint8_t *mask = (uint8_t *)malloc(rows ? rows : 1);
+  if (!mask) {
+    fprintf(stderr, "kernels: out of memory\n");
+    return 0;
+  }
+  int ok = 1;
+  for (size_t k = 0; ok && k < 8; ++k) {
+    BenchCase bc;
+    memset(&bc, 0, sizeof(bc));
+    bc.bench = "kernels";
+    bc.df = table;
+    bc.key = kernels[k];
+    bc.rows = rows;
+    bc.bytes = bytes_per_row[k] * (double)rows;
+    bc.mask = mask;
+    bc.run = run_kernel;
+    snprintf(bc.params, sizeof(bc.params), "kernel=%s,simd=%s", kernels[k],
+             cp_simd_isa());
+    ok = measure_case(&bc, opts);
+  }
+  free(mask);
+  return ok;
+}
+
+static int bench_append(const BenchOptions *opts) {
+  BenchCase bc;
+  memset(&bc, 0, sizeof(bc));
+  bc.bench = "append";
+  bc.rows = opts->rows;
+  bc.run = run_append;
+  snprintf(bc.params, sizeof(bc.params), "cols=3");
+  return measure_case(&bc, opts);
+}
+
+static const char *bench_names[] = {
+    "append",  "csv-read", "csv-write", "parquet-read", "parquet-write",
+    "cpd-read", "cpd-write", "sort",    "groupby",      "query",
+    "pivot",   "resample", "rolling",   "join",         "kernels"};
+static const size_t bench_name_count =
+    sizeof(bench_names) / sizeof(bench_names[0]);
+
+static int is_bench_name(const char *name) {
+  if (strcmp(name, "all") == 0) {
+    return 1;
+  }
+  for (size_t i = 0; i < bench_name_count; ++i) {
+    if (strcmp(name, bench_names[i]) == 0) {
+      return 1;
+    }
+  }
   return 0;
 }
+
+static int run_bench(const char *name,
+                     const BenchOptions *opts,
+                     CpDataFrame **table,
+                     size_t table_cardinality) {
+  if (strcmp(name, "append") == 0) {
+    return bench_append(opts);
+  }
+  if (strcmp(name, "join") == 0) {
+    return bench_join(opts);
+  }
+  if (!*table) {
+    CpError err;
+    cp_error_clear(&err);
+    *table = make_table(opts->rows, table_cardinality, &err);
+    if (!*table) {
+      fprintf(stderr, "failed to create benchmark table: %s\n", err.message);
+      return 0;
+    }
+  }
+  if (strstr(name, "-read") || strstr(name, "-write")) {
+    return bench_file(name, *table, opts);
+  }
+  if (strcmp(name, "groupby") == 0) {
+    return bench_groupby(opts, *table, table_cardinality);
+  }
+  if (strcmp(name, "kernels") == 0) {
+    return bench_kernels(*table, opts);
+  }
+  if (strcmp(name, "sort") == 0) {
+    return bench_frame_op(name, "price", *table, table_cardinality, run_sort,
+                          opts) &&
+           bench_frame_op(name, "sym", *table, table_cardinality, run_sort,
+                          opts);
+  }
+  if (strcmp(name, "pivot") == 0) {
+    return bench_frame_op(name, "key", *table, table_cardinality, run_pivot,
+                          opts);
+  }
+  int (*run)(BenchCase *, CpError *) = run_query;
+  if (strcmp(name, "resample") == 0) {
+    run = run_resample;
+  } else if (strcmp(name, "rolling") == 0) {
+    run = run_rolling;
+  }
+  return bench_frame_op(name, NULL, *table, table_cardinality, run, opts);
+}
+
+static void print_table(void) {
+  printf("%-13s %-38s %7s %10s %12s %10s %8s %10s\n", "bench", "params",
+         "threads", "median_s", "rows/s", "MB/s", "rss_MB", "out_rows");
+  for (size_t i = 0; i < bench_result_count; ++i) {
+    const BenchResult *res = &bench_results[i];
+    double rows_s = res->median_s > 0.0 ? (double)res->rows / res->median_s
+                                        : 0.0;
+    double mb_s = res->median_s > 0.0 ? res->bytes / res->median_s / 1e6 : 0.0;
+    printf("%-13s %-38s %7zu %10.4f %12.0f %10.1f %8.1f %10zu\n", res->bench,
+           res->params, res->threads, res->median_s, rows_s, mb_s,
+           (double)res->peak_rss / (1024.0 * 1024.0), res->out_rows);
+  }
+}
+
+static void print_json(const BenchOptions *opts) {
+  printf("{\n  \"suite\": \"cpandas_bench\",\n");
+  printf("  \"simd\": \"%s\",\n", cp_simd_isa());
+#ifdef CPANDAS_HAVE_OPENMP
+  printf("  \"openmp\": true,\n");
+#else
+  printf("  \"openmp\": false,\n");
+#endif
+  printf("  \"warmup\": %zu,\n  \"reps\": %zu,\n", opts->warmup, opts->reps);
+  printf("  \"results\": [");
+  for (size_t i = 0; i < bench_result_count; ++i) {
+    const BenchResult *res = &bench_results[i];
+    double rows_s = res->median_s > 0.0 ? (double)res->rows / res->median_s
+                                        : 0.0;
+    double bytes_s = res->median_s > 0.0 ? res->bytes / res->median_s : 0.0;
+    printf("%s\n    {\"bench\": \"%s\", \"params\": \"%s\", \"threads\": %zu, "
+           "\"rows\": %zu, \"out_rows\": %zu, \"bytes\": %.0f, "
+           "\"min_s\": %.9f, \"median_s\": %.9f, \"mean_s\": %.9f, "
+           "\"rows_per_s\": %.1f, \"bytes_per_s\": %.1f, "
+           "\"peak_rss_bytes\": %zu}",
+           i ? "," : "", res->bench, res->params, res->threads, res->rows,
+           res->out_rows, res->bytes, res->min_s, res->median_s, res->mean_s,
+           rows_s, bytes_s, res->peak_rss);
+  }
+  printf("\n  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+  BenchOptions opts;
+  memset(&opts, 0, sizeof(opts));
+  opts.rows = 200000;
+  opts.warmup = 1;
+  opts.reps = 5;
+  opts.join_strategy = CP_JOIN_STRATEGY_AUTO;
+  opts.match_rate = 1.0;
+  opts.dir = ".";
+  const char *bench = "append";
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    int ok = 1;
+    if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+      print_usage(argv[0]);
+      return 0;
+    } else if (strcmp(arg, "--join") == 0) {
+      bench = "join";
+    } else if (strcmp(arg, "--groupby") == 0) {
+      bench = "groupby";
+    } else if (strcmp(arg, "--kernels") == 0) {
+      bench = "kernels";
+    } else if (strcmp(arg, "--json") == 0) {
+      opts.json = 1;
+    } else if (strcmp(arg, "--rows") == 0) {
+      ok = value && parse_size(value, &opts.rows, 0);
+      i += 1;
+    } else if (strcmp(arg, "--warmup") == 0) {
+      ok = value && parse_size(value, &opts.warmup, 1);
+      i += 1;
+    } else if (strcmp(arg, "--reps") == 0) {
+      ok = value && parse_size(value, &opts.reps, 0);
+      i += 1;
+    } else if (strcmp(arg, "--threads") == 0) {
+      ok = value && parse_thread_list(value, &opts);
+      i += 1;
+    } else if (strcmp(arg, "--cardinality") == 0) {
+      ok = value && parse_size(value, &opts.cardinality, 0);
+      i += 1;
+    } else if (strcmp(arg, "--strategy") == 0 ||
+               strcmp(arg, "--join-strategy") == 0) {
+      ok = value &&
+           parse_join_strategy(value, &opts.join_strategy, &opts.join_all);
+      if (strcmp(bench, "all") != 0) {
+        bench = "join";
+      }
+      i += 1;
+    } else if (strcmp(arg, "--match-rate") == 0) {
+      ok = value && parse_rate(value, &opts.match_rate);
+      i += 1;
+    } else if (strcmp(arg, "--key-dup-rate") == 0) {
+      ok = value && parse_rate(value, &opts.key_dup_rate);
+      i += 1;
+    } else if (strcmp(arg, "--dir") == 0) {
+      ok = value != NULL;
+      opts.dir = value;
+      i += 1;
+    } else if (is_bench_name(arg)) {
+      bench = arg;
+    } else {
+      ok = arg[0] != '-' && parse_size(arg, &opts.rows, 0);
+    }
+    if (!ok) {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (opts.thread_count == 0) {
+    opts.threads[0] = default_threads();
+    opts.thread_count = 1;
+  }
+#ifndef CPANDAS_HAVE_OPENMP
+  if (opts.thread_count > 1 || opts.threads[0] != 1) {
+    fprintf(stderr, "built without OpenMP; running single-threaded\n");
+    opts.threads[0] = 1;
+    opts.thread_count = 1;
+  }
+#endif
+
+  size_t table_cardinality = opts.cardinality ? opts.cardinality : 1024;
+  if (table_cardinality > opts.rows) {
+    table_cardinality = opts.rows;
+  }
+  CpDataFrame *table = NULL;
+  int ok = 1;
+  if (strcmp(bench, "all") == 0) {
+    for (size_t i = 0; ok && i < bench_name_count; ++i) {
+      ok = run_bench(bench_names[i], &opts, &table, table_cardinality);
+    }
+  } else {
+    ok = run_bench(bench, &opts, &table, table_cardinality);
+  }
+  cp_df_free(table);
+
+  if (opts.json) {
+    print_json(&opts);
+  } else {
+    print_table();
+  }
+  return ok ? 0 : 1;
+}
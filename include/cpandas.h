@@ -12,7 +12,8 @@ extern "C" {
 typedef enum {
   CP_DTYPE_INT64 = 0,
   CP_DTYPE_FLOAT64 = 1,
-  CP_DTYPE_STRING = 2
+  CP_DTYPE_STRING = 2,
+  CP_DTYPE_CATEGORY = 3
 } CpDType;
 
 typedef enum {
@@ -47,6 +48,15 @@ typedef enum {
   CP_AGG_MAX = 4
 } CpAggOp;
 
+typedef enum {
+  CP_ROLLING_COUNT = 0,
+  CP_ROLLING_SUM = 1,
+  CP_ROLLING_MEAN = 2,
+  CP_ROLLING_MIN = 3,
+  CP_ROLLING_MAX = 4,
+  CP_ROLLING_STD = 5
+} CpRollingOp;
+
 typedef enum {
   CP_JOIN_INNER = 0,
   CP_JOIN_LEFT = 1,
@@ -54,11 +64,18 @@ typedef enum {
   CP_JOIN_OUTER = 3
 } CpJoinType;
 
+typedef enum {
+  CP_ASOF_BACKWARD = 0,
+  CP_ASOF_FORWARD = 1,
+  CP_ASOF_NEAREST = 2
+} CpAsofDirection;
+
 typedef enum {
   CP_JOIN_STRATEGY_AUTO = 0,
   CP_JOIN_STRATEGY_NESTED = 1,
   CP_JOIN_STRATEGY_HASH = 2,
-  CP_JOIN_STRATEGY_SORTED = 3
+  CP_JOIN_STRATEGY_SORTED = 3,
+  CP_JOIN_STRATEGY_PARTITIONED_HASH = 4
 } CpJoinStrategy;
 
 typedef enum {
@@ -67,6 +84,12 @@ typedef enum {
   CP_DUP_KEEP_NONE = 2
 } CpDuplicateKeep;
 
+typedef enum {
+  CP_NSELECT_KEEP_FIRST = 0,
+  CP_NSELECT_KEEP_LAST = 1,
+  CP_NSELECT_KEEP_ALL = 2
+} CpNSelectKeep;
+
 typedef enum {
   CP_CONCAT_ROWS = 0,
   CP_CONCAT_COLS = 1
@@ -120,8 +143,61 @@ typedef struct {
   } value;
 } CpValue;
 
+typedef struct {
+  const char *column;
+  CpCompareOp op;
+  const char *value;
+} CpParquetPredicate;
+
+typedef struct {
+  const char **columns;
+  size_t column_count;
+  const char **category_columns;
+  size_t category_count;
+  const CpParquetPredicate *predicates;
+  size_t predicate_count;
+} CpParquetReadOptions;
+
+typedef struct {
+  size_t row_group_bytes;
+} CpParquetWriterOptions;
+
 typedef struct CpSeries CpSeries;
 typedef struct CpDataFrame CpDataFrame;
+typedef struct CpRowView CpRowView;
+typedef struct CpLazyFrame CpLazyFrame;
+typedef struct CpParquetWriter CpParquetWriter;
+typedef struct CpReader CpReader;
+typedef struct CpGroupbyState CpGroupbyState;
+typedef struct CpArena CpArena;
+
+typedef struct {
+  void *(*malloc_fn)(size_t size, void *user_data);
+  void *(*realloc_fn)(void *ptr, size_t size, void *user_data);
+  void (*free_fn)(void *ptr, void *user_data);
+  void *user_data;
+} CpAllocator;
+
+typedef struct {
+  const char *name;
+  double wall_seconds;
+  double cpu_seconds;
+} CpTracePhase;
+
+typedef struct {
+  const char *op;
+  const char *strategy;
+  const CpTracePhase *phases;
+  size_t phase_count;
+  double wall_seconds;
+  double cpu_seconds;
+  size_t rows_in;
+  size_t rows_out;
+  size_t bytes_allocated;
+  int ok;
+} CpTraceEvent;
+
+typedef void (*CpTraceFn)(const CpTraceEvent *event, void *user_data);
 
 typedef int (*CpApplyFn)(const CpDataFrame *df,
                          size_t row,
@@ -133,6 +209,18 @@ typedef int (*CpTransformFn)(const CpSeries *series,
                              void *user_data,
                              CpValue *out,
                              CpError *err);
+typedef int (*CpApplyBatchFn)(const CpDataFrame *df,
+                              size_t start,
+                              size_t count,
+                              void *user_data,
+                              CpSeries *out,
+                              CpError *err);
+typedef int (*CpTransformBatchFn)(const CpSeries *series,
+                                  size_t start,
+                                  size_t count,
+                                  void *user_data,
+                                  CpSeries *out,
+                                  CpError *err);
 typedef int (*CpIterRowFn)(const CpDataFrame *df,
                            size_t row,
                            void *user_data,
@@ -143,6 +231,18 @@ typedef int (*CpIterItemFn)(const CpSeries *series,
                             CpError *err);
 
 void cp_error_clear(CpError *err);
+const char *cp_simd_isa(void);
+int cp_set_simd_isa(const char *name, CpError *err);
+
+int cp_set_allocator(const CpAllocator *allocator, CpError *err);
+void cp_get_allocator(CpAllocator *out);
+void cp_free(void *ptr);
+CpArena *cp_arena_create(size_t block_bytes, CpError *err);
+CpAllocator cp_arena_allocator(CpArena *arena);
+size_t cp_arena_bytes(const CpArena *arena);
+void cp_arena_reset(CpArena *arena);
+void cp_arena_free(CpArena *arena);
+int cp_set_trace_callback(CpTraceFn fn, void *user_data, CpError *err);
 
 CpDataFrame *cp_df_create(size_t ncols,
                           const char **names,
@@ -159,6 +259,12 @@ int cp_df_shape(const CpDataFrame *df,
                 CpError *err);
 size_t cp_df_size(const CpDataFrame *df);
 size_t cp_df_ndim(const CpDataFrame *df);
+int cp_df_memory_usage(const CpDataFrame *df,
+                       int deep,
+                       size_t *out,
+                       size_t out_len,
+                       size_t *out_total,
+                       CpError *err);
 int cp_df_columns(const CpDataFrame *df,
                   const char **out,
                   size_t out_len,
@@ -212,6 +318,29 @@ CpDataFrame *cp_df_groupby_agg(const CpDataFrame *df,
                                const CpAggOp *ops,
                                size_t count,
                                CpError *err);
+CpDataFrame *cp_df_groupby_agg_multi(const CpDataFrame *df,
+                                     const char **keys,
+                                     size_t key_count,
+                                     const char **value_cols,
+                                     const CpAggOp *ops,
+                                     size_t count,
+                                     CpError *err);
+CpGroupbyState *cp_groupby_state_create(const char **keys,
+                                        size_t key_count,
+                                        const char **value_cols,
+                                        const CpAggOp *ops,
+                                        size_t count,
+                                        CpError *err);
+int cp_groupby_state_update(CpGroupbyState *state,
+                            const CpDataFrame *batch,
+                            CpError *err);
+int cp_groupby_state_merge(CpGroupbyState *dst,
+                           const CpGroupbyState *src,
+                           CpError *err);
+size_t cp_groupby_state_ngroups(const CpGroupbyState *state);
+CpDataFrame *cp_groupby_state_finalize(const CpGroupbyState *state,
+                                       CpError *err);
+void cp_groupby_state_free(CpGroupbyState *state);
 CpDataFrame *cp_df_pivot_table_multi(const CpDataFrame *df,
                                      const char **index_cols,
                                      size_t index_count,
@@ -234,12 +363,34 @@ CpDataFrame *cp_df_resample(const CpDataFrame *df,
                             const CpAggOp *ops,
                             size_t count,
                             CpError *err);
+CpDataFrame *cp_df_rolling(const CpDataFrame *df,
+                           const char *time_col,
+                           size_t window_rows,
+                           int64_t window_seconds,
+                           size_t min_periods,
+                           const char **value_cols,
+                           const CpRollingOp *ops,
+                           size_t count,
+                           CpError *err);
+CpDataFrame *cp_df_expanding(const CpDataFrame *df,
+                             size_t min_periods,
+                             const char **value_cols,
+                             const CpRollingOp *ops,
+                             size_t count,
+                             CpError *err);
 CpDataFrame *cp_df_join(const CpDataFrame *left,
                         const CpDataFrame *right,
                         const char *left_key,
                         const char *right_key,
                         CpJoinType how,
                         CpError *err);
+CpDataFrame *cp_df_join_asof(const CpDataFrame *left,
+                             const CpDataFrame *right,
+                             const char *on,
+                             const char *by,
+                             CpAsofDirection direction,
+                             int64_t tolerance,
+                             CpError *err);
 CpDataFrame *cp_df_join_with_strategy(const CpDataFrame *left,
                                       const CpDataFrame *right,
                                       const char *left_key,
@@ -439,6 +590,11 @@ CpDataFrame *cp_df_set_index(const CpDataFrame *df,
                              CpError *err);
 CpDataFrame *cp_df_reset_index(const CpDataFrame *df,
                                CpError *err);
+int cp_df_find_row(const CpDataFrame *df,
+                   const CpValue *levels,
+                   size_t level_count,
+                   size_t *out_row,
+                   CpError *err);
 int cp_df_at_int64(const CpDataFrame *df,
                    const char *row_label,
                    const char *col_name,
@@ -469,6 +625,22 @@ CpDataFrame *cp_df_transform(const CpDataFrame *df,
                              CpTransformFn func,
                              void *user_data,
                              CpError *err);
+CpDataFrame *cp_df_apply_batch(const CpDataFrame *df,
+                               CpDType out_dtype,
+                               const char *out_name,
+                               CpApplyBatchFn func,
+                               void *user_data,
+                               size_t batch_rows,
+                               int thread_safe,
+                               CpError *err);
+CpDataFrame *cp_df_transform_batch(const CpDataFrame *df,
+                                   const char *name,
+                                   CpDType out_dtype,
+                                   CpTransformBatchFn func,
+                                   void *user_data,
+                                   size_t batch_rows,
+                                   int thread_safe,
+                                   CpError *err);
 int cp_df_iterrows(const CpDataFrame *df,
                    CpIterRowFn func,
                    void *user_data,
@@ -502,6 +674,98 @@ CpDataFrame *cp_df_cov(const CpDataFrame *df,
 CpDataFrame *cp_df_query(const CpDataFrame *df,
                          const char *expr,
                          CpError *err);
+
+CpRowView *cp_df_rows_view(const CpDataFrame *df, CpError *err);
+void cp_row_view_free(CpRowView *view);
+size_t cp_row_view_nrows(const CpRowView *view);
+const size_t *cp_row_view_rows(const CpRowView *view);
+const CpDataFrame *cp_row_view_base(const CpRowView *view);
+CpRowView *cp_row_view_take(const CpRowView *view,
+                            const size_t *rows,
+                            size_t count,
+                            CpError *err);
+CpRowView *cp_row_view_filter_mask(const CpRowView *view,
+                                   const uint8_t *mask,
+                                   size_t mask_len,
+                                   CpError *err);
+CpRowView *cp_row_view_filter_int64(const CpRowView *view,
+                                    const char *name,
+                                    CpCompareOp op,
+                                    int64_t value,
+                                    CpError *err);
+CpRowView *cp_row_view_filter_float64(const CpRowView *view,
+                                      const char *name,
+                                      CpCompareOp op,
+                                      double value,
+                                      CpError *err);
+CpRowView *cp_row_view_filter_string(const CpRowView *view,
+                                     const char *name,
+                                     CpCompareOp op,
+                                     const char *value,
+                                     CpError *err);
+CpRowView *cp_row_view_query(const CpRowView *view,
+                             const char *expr,
+                             CpError *err);
+CpRowView *cp_row_view_dropna(const CpRowView *view, CpError *err);
+CpDataFrame *cp_row_view_groupby_agg(const CpRowView *view,
+                                     const char *key,
+                                     const char **value_cols,
+                                     const CpAggOp *ops,
+                                     size_t count,
+                                     CpError *err);
+CpDataFrame *cp_row_view_groupby_agg_multi(const CpRowView *view,
+                                           const char **keys,
+                                           size_t key_count,
+                                           const char **value_cols,
+                                           const CpAggOp *ops,
+                                           size_t count,
+                                           CpError *err);
+CpDataFrame *cp_df_materialize(const CpRowView *view, CpError *err);
+
+CpLazyFrame *cp_lazy_from_df(const CpDataFrame *df, CpError *err);
+CpLazyFrame *cp_lazy_scan_csv(const char *path,
+                              char delimiter,
+                              int has_header,
+                              const CpDType *dtypes,
+                              size_t dtype_count,
+                              CpError *err);
+CpLazyFrame *cp_lazy_scan_parquet(const char *path, CpError *err);
+CpLazyFrame *cp_lazy_filter(CpLazyFrame *lf, const char *expr, CpError *err);
+CpLazyFrame *cp_lazy_select(CpLazyFrame *lf,
+                            const char **names,
+                            size_t count,
+                            CpError *err);
+CpLazyFrame *cp_lazy_arith_scalar(CpLazyFrame *lf,
+                                  const char *name,
+                                  CpArithOp op,
+                                  double value,
+                                  const char *out_name,
+                                  CpError *err);
+CpLazyFrame *cp_lazy_arith_cols(CpLazyFrame *lf,
+                                const char *left,
+                                const char *right,
+                                CpArithOp op,
+                                const char *out_name,
+                                CpError *err);
+CpLazyFrame *cp_lazy_groupby_agg(CpLazyFrame *lf,
+                                 const char **keys,
+                                 size_t key_count,
+                                 const char **value_cols,
+                                 const CpAggOp *ops,
+                                 size_t count,
+                                 CpError *err);
+CpLazyFrame *cp_lazy_join(CpLazyFrame *left,
+                          CpLazyFrame *right,
+                          const char **left_keys,
+                          const char **right_keys,
+                          size_t key_count,
+                          CpJoinType how,
+                          const char *left_suffix,
+                          const char *right_suffix,
+                          CpError *err);
+char *cp_lazy_explain(CpLazyFrame *lf, CpError *err);
+CpDataFrame *cp_lazy_collect(CpLazyFrame *lf, CpError *err);
+void cp_lazy_free(CpLazyFrame *lf);
 CpDataFrame *cp_df_concat(const CpDataFrame **dfs,
                           size_t count,
                           CpConcatAxis axis,
@@ -519,6 +783,16 @@ CpDataFrame *cp_df_nsmallest(const CpDataFrame *df,
                              const char *name,
                              size_t n,
                              CpError *err);
+CpDataFrame *cp_df_nlargest_keep(const CpDataFrame *df,
+                                 const char *name,
+                                 size_t n,
+                                 CpNSelectKeep keep,
+                                 CpError *err);
+CpDataFrame *cp_df_nsmallest_keep(const CpDataFrame *df,
+                                  const char *name,
+                                  size_t n,
+                                  CpNSelectKeep keep,
+                                  CpError *err);
 
 int cp_df_append_row(CpDataFrame *df,
                      const char **values,
@@ -551,6 +825,15 @@ CpDataFrame *cp_df_read_tsv_with_na(const char *path,
                                     const char **na_values,
                                     size_t na_count,
                                     CpError *err);
+CpDataFrame *cp_df_read_csv_parallel(const char *path,
+                                     char delimiter,
+                                     int has_header,
+                                     const CpDType *dtypes,
+                                     size_t dtype_count,
+                                     const char **na_values,
+                                     size_t na_count,
+                                     size_t num_threads,
+                                     CpError *err);
 CpDataFrame *cp_df_read_json(const char *path,
                              const CpDType *dtypes,
                              size_t dtype_count,
@@ -560,7 +843,36 @@ CpDataFrame *cp_df_read_ndjson(const char *path,
                                size_t dtype_count,
                                CpError *err);
 CpDataFrame *cp_df_read_cpd(const char *path, CpError *err);
+CpDataFrame *cp_df_open_cpd_mmap(const char *path, CpError *err);
 CpDataFrame *cp_df_read_parquet(const char *path, CpError *err);
+CpDataFrame *cp_df_read_parquet_categories(const char *path,
+                                           const char **columns,
+                                           size_t count,
+                                           CpError *err);
+CpDataFrame *cp_df_read_parquet_ex(const char *path,
+                                   const CpParquetReadOptions *options,
+                                   CpError *err);
+CpReader *cp_reader_open_csv(const char *path,
+                             char delimiter,
+                             int has_header,
+                             const CpDType *dtypes,
+                             size_t dtype_count,
+                             const char **na_values,
+                             size_t na_count,
+                             CpError *err);
+CpReader *cp_reader_open_ndjson(const char *path,
+                                const CpDType *dtypes,
+                                size_t dtype_count,
+                                CpError *err);
+CpReader *cp_reader_open_parquet(const char *path,
+                                 const CpParquetReadOptions *options,
+                                 CpError *err);
+CpReader *cp_reader_open_cpd(const char *path, CpError *err);
+int cp_reader_next(CpReader *reader,
+                   size_t max_rows,
+                   CpDataFrame **batch,
+                   CpError *err);
+void cp_reader_free(CpReader *reader);
 int cp_df_write_csv(const CpDataFrame *df,
                     const char *path,
                     char delimiter,
@@ -582,6 +894,14 @@ int cp_df_write_cpd(const CpDataFrame *df,
 int cp_df_write_parquet(const CpDataFrame *df,
                         const char *path,
                         CpError *err);
+CpParquetWriter *cp_parquet_writer_open(const char *path,
+                                        const CpDataFrame *schema,
+                                        const CpParquetWriterOptions *options,
+                                        CpError *err);
+int cp_parquet_writer_write_batch(CpParquetWriter *writer,
+                                  const CpDataFrame *batch,
+                                  CpError *err);
+int cp_parquet_writer_close(CpParquetWriter *writer, CpError *err);
 int cp_df_to_excel(const CpDataFrame *df,
                    const char *path,
                    CpError *err);
@@ -596,9 +916,18 @@ int cp_df_plot(const CpDataFrame *df,
 const char *cp_series_name(const CpSeries *s);
 CpDType cp_series_dtype(const CpSeries *s);
 size_t cp_series_len(const CpSeries *s);
+const int64_t *cp_series_int64_values(const CpSeries *s);
+const double *cp_series_float64_values(const CpSeries *s);
+int64_t *cp_series_int64_buffer(CpSeries *s);
+double *cp_series_float64_buffer(CpSeries *s);
+int cp_series_is_null(const CpSeries *s, size_t idx);
+int cp_series_set_null_at(CpSeries *s, size_t idx, CpError *err);
 int cp_series_get_int64(const CpSeries *s, size_t idx, int64_t *out, int *is_null);
 int cp_series_get_float64(const CpSeries *s, size_t idx, double *out, int *is_null);
 int cp_series_get_string(const CpSeries *s, size_t idx, const char **out, int *is_null);
+int cp_series_get_category_code(const CpSeries *s, size_t idx, int32_t *out, int *is_null);
+size_t cp_series_category_count(const CpSeries *s);
+const char *cp_series_category_value(const CpSeries *s, int32_t code);
 void cp_series_free(CpSeries *s);
 CpSeries *cp_series_ffill(const CpSeries *s, CpError *err);
 CpSeries *cp_series_bfill(const CpSeries *s, CpError *err);
@@ -619,6 +948,11 @@ int cp_series_mean(const CpSeries *s,
                    size_t *out_count,
                    size_t *out_nulls,
                    CpError *err);
+int cp_series_quantile(const CpSeries *s,
+                       const double *qs,
+                       size_t nq,
+                       double *out,
+                       CpError *err);
 int cp_series_min_int64(const CpSeries *s,
                         int64_t *out,
                         size_t *out_nulls,
@@ -665,6 +999,12 @@ int cp_df_median(const CpDataFrame *df,
                  size_t *out_count,
                  size_t *out_nulls,
                  CpError *err);
+int cp_df_quantile(const CpDataFrame *df,
+                   const char *name,
+                   const double *qs,
+                   size_t nq,
+                   double *out,
+                   CpError *err);
 int cp_df_std(const CpDataFrame *df,
               const char *name,
               double *out,
@@ -53,6 +53,13 @@ static char *make_temp_path(void) {
 #endif
 }
 
+static void free_temp_path(char *path) {
+  if (path) {
+    remove(path);
+    free(path);
+  }
+}
+
 static char *resolve_fixture_path(const char *rel_path) {
   if (!rel_path || rel_path[0] == '\0') {
     return NULL;
@@ -179,6 +186,71 @@ static int transform_double(const CpSeries *series,
   return 1;
 }
 
+static int apply_sum_batch(const CpDataFrame *df,
+                           size_t start,
+                           size_t count,
+                           void *user_data,
+                           CpSeries *out,
+                           CpError *err) {
+  (void)user_data;
+  const CpSeries *id = cp_df_get_col(df, "id");
+  const CpSeries *score = cp_df_get_col(df, "score");
+  const int64_t *ids = cp_series_int64_values(id);
+  const double *scores = cp_series_float64_values(score);
+  int64_t *dst = cp_series_int64_buffer(out);
+  if (!ids || !scores || !dst || cp_series_len(out) != count) {
+    return 0;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    size_t row = start + i;
+    if (cp_series_is_null(id, row) || cp_series_is_null(score, row)) {
+      if (!cp_series_set_null_at(out, i, err)) {
+        return 0;
+      }
+      continue;
+    }
+    dst[i] = ids[row] + (int64_t)scores[row];
+  }
+  return 1;
+}
+
+static int apply_fail_batch(const CpDataFrame *df,
+                            size_t start,
+                            size_t count,
+                            void *user_data,
+                            CpSeries *out,
+                            CpError *err) {
+  (void)df;
+  (void)count;
+  (void)out;
+  (void)err;
+  return start < *(const size_t *)user_data;
+}
+
+static int transform_double_batch(const CpSeries *series,
+                                  size_t start,
+                                  size_t count,
+                                  void *user_data,
+                                  CpSeries *out,
+                                  CpError *err) {
+  (void)user_data;
+  const double *src = cp_series_float64_values(series);
+  double *dst = cp_series_float64_buffer(out);
+  if (!src || !dst) {
+    return 0;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (cp_series_is_null(series, start + i)) {
+      if (!cp_series_set_null_at(out, i, err)) {
+        return 0;
+      }
+      continue;
+    }
+    dst[i] = src[start + i] * 2.0;
+  }
+  return 1;
+}
+
 typedef struct {
   const CpSeries *id;
   int64_t sum;
@@ -1253,180 +1325,1319 @@ static void test_read_csv_mismatch(void) {
   free(path);
 }
 
-static void test_aggregations(void) {
+static void test_read_csv_blocks(void) {
   CpError err;
   cp_error_clear(&err);
 
-  const char *names[] = {"ival", "fval"};
-  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64};
-  CpDataFrame *df = cp_df_create(2, names, dtypes, 0, &err);
-  CHECK(df != NULL);
-  if (!df) {
+  char *path = make_temp_path();
+  CHECK(path != NULL);
+  if (!path) {
     return;
   }
 
-  const char *row1[] = {"1", "1.5"};
-  const char *row2[] = {"2", ""};
-  const char *row3[] = {"", "-2.25"};
-  const char *row4[] = {"-5", "0"};
-
-  CHECK(cp_df_append_row(df, row1, 2, &err));
-  CHECK(cp_df_append_row(df, row2, 2, &err));
-  CHECK(cp_df_append_row(df, row3, 2, &err));
-  CHECK(cp_df_append_row(df, row4, 2, &err));
-
-  const CpSeries *ival = cp_df_get_col(df, "ival");
-  const CpSeries *fval = cp_df_get_col(df, "fval");
-  CHECK(ival && fval);
-
-  size_t count = 0;
-  size_t nulls = 0;
-  int64_t isum = 0;
-  double fsum = 0.0;
-  double mean = 0.0;
-  int64_t imin = 0;
-  int64_t imax = 0;
-  double fmin = 0.0;
-  double fmax = 0.0;
-
-  CHECK(cp_series_count(ival, &count, &nulls, &err));
-  CHECK(count == 3 && nulls == 1);
-  CHECK(cp_series_sum_int64(ival, &isum, &count, &nulls, &err));
-  CHECK(isum == -2 && count == 3 && nulls == 1);
-  CHECK(cp_series_mean(ival, &mean, &count, &nulls, &err));
-  CHECK(fabs(mean - (-2.0 / 3.0)) < 1e-9);
-  CHECK(cp_series_min_int64(ival, &imin, &nulls, &err));
-  CHECK(imin == -5 && nulls == 1);
-  CHECK(cp_series_max_int64(ival, &imax, &nulls, &err));
-  CHECK(imax == 2 && nulls == 1);
-
-  CHECK(cp_series_count(fval, &count, &nulls, &err));
-  CHECK(count == 3 && nulls == 1);
-  CHECK(cp_series_sum_float64(fval, &fsum, &count, &nulls, &err));
-  CHECK(fabs(fsum - (-0.75)) < 1e-9 && count == 3 && nulls == 1);
-  CHECK(cp_series_mean(fval, &mean, &count, &nulls, &err));
-  CHECK(fabs(mean - (-0.25)) < 1e-9);
-  CHECK(cp_series_min_float64(fval, &fmin, &nulls, &err));
-  CHECK(fabs(fmin - (-2.25)) < 1e-9 && nulls == 1);
-  CHECK(cp_series_max_float64(fval, &fmax, &nulls, &err));
-  CHECK(fabs(fmax - 1.5) < 1e-9 && nulls == 1);
+  const size_t long_len = 200000;
+  const size_t rows = 5000;
+  FILE *fp = fopen(path, "wb");
+  CHECK(fp != NULL);
+  if (!fp) {
+    free_temp_path(path);
+    return;
+  }
+  fputs("id,name,price\r\n", fp);
+  fputs("0,\"", fp);
+  for (size_t i = 0; i < long_len; ++i) {
+    fputc(i % 1000 == 0 ? ',' : 'x', fp);
+  }
+  fputs("\",1.5\r\n", fp);
+  for (size_t i = 1; i < rows; ++i) {
+    if (i % 10 == 0) {
+      fprintf(fp, "%zu,\"say \"\"hi\"\"\",NA\n", i);
+    } else {
+      fprintf(fp, "%zu,n%zu,%zu.25\n", i, i, i);
+    }
+    if (i % 1000 == 0) {
+      fputs("\n", fp);
+    }
+  }
+  fputs("99999,last,2.5", fp);
+  fclose(fp);
 
-  cp_df_free(df);
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_STRING, CP_DTYPE_FLOAT64};
+  const char *na_values[] = {"NA"};
+  CpDataFrame *df =
+      cp_df_read_csv_with_na(path, ',', 1, dtypes, 3, na_values, 1, &err);
+  CHECK(df != NULL);
+  if (df) {
+    CHECK(cp_df_nrows(df) == rows + 1);
+    const CpSeries *id = cp_df_get_col(df, "id");
+    const CpSeries *name = cp_df_get_col(df, "name");
+    const CpSeries *price = cp_df_get_col(df, "price");
+    CHECK(id && name && price);
+    const char *value = NULL;
+    double price_val = 0.0;
+    int64_t id_val = 0;
+    int is_null = 0;
+    if (id && name && price) {
+      CHECK(cp_series_get_string(name, 0, &value, &is_null));
+      CHECK(!is_null && strlen(value) == long_len && value[0] == ',' &&
+            value[1] == 'x');
+      CHECK(cp_series_get_float64(price, 0, &price_val, &is_null));
+      CHECK(!is_null && fabs(price_val - 1.5) < 1e-9);
+      CHECK(cp_series_get_string(name, 10, &value, &is_null));
+      CHECK(!is_null && strcmp(value, "say \"hi\"") == 0);
+      CHECK(cp_series_get_float64(price, 10, &price_val, &is_null));
+      CHECK(is_null);
+      CHECK(cp_series_get_float64(price, 4321, &price_val, &is_null));
+      CHECK(!is_null && fabs(price_val - 4321.25) < 1e-9);
+      CHECK(cp_series_get_int64(id, rows, &id_val, &is_null));
+      CHECK(!is_null && id_val == 99999);
+    }
+    cp_df_free(df);
+  }
 
+  CHECK(write_file(path, "a,b\n1,2\n3,x\n"));
+  CpDType int_types[] = {CP_DTYPE_INT64, CP_DTYPE_INT64};
   cp_error_clear(&err);
-  const char *null_names[] = {"empty"};
-  CpDType null_dtypes[] = {CP_DTYPE_INT64};
-  CpDataFrame *null_df = cp_df_create(1, null_names, null_dtypes, 0, &err);
-  CHECK(null_df != NULL);
-  if (null_df) {
-    const char *null_row1[] = {""};
-    const char *null_row2[] = {"   "};
-    CHECK(cp_df_append_row(null_df, null_row1, 1, &err));
-    CHECK(cp_df_append_row(null_df, null_row2, 1, &err));
+  df = cp_df_read_csv(path, ',', 1, int_types, 2, &err);
+  CHECK(df == NULL);
+  CHECK(err.code == CP_ERR_PARSE && err.row == 1 && err.col == 1);
 
-    const CpSeries *empty = cp_df_get_col(null_df, "empty");
-    CHECK(empty != NULL);
+  CHECK(write_file(path, "a,b\n1,\"open\n"));
+  cp_error_clear(&err);
+  df = cp_df_read_csv(path, ',', 1, int_types, 2, &err);
+  CHECK(df == NULL);
+  CHECK(err.code == CP_ERR_PARSE);
 
-    CHECK(!cp_series_mean(empty, NULL, NULL, NULL, &err));
-    CHECK(err.code == CP_ERR_INVALID);
+  remove(path);
+  free(path);
+}
 
-    cp_df_free(null_df);
+static int csv_frames_match(const CpDataFrame *a,
+                            const CpDataFrame *b,
+                            const char **names,
+                            size_t ncols) {
+  if (cp_df_nrows(a) != cp_df_nrows(b) || cp_df_ncols(a) != ncols ||
+      cp_df_ncols(b) != ncols) {
+    return 0;
+  }
+  for (size_t col = 0; col < ncols; ++col) {
+    const CpSeries *sa = cp_df_get_col(a, names[col]);
+    const CpSeries *sb = cp_df_get_col(b, names[col]);
+    if (!sa || !sb || cp_series_dtype(sa) != cp_series_dtype(sb)) {
+      return 0;
+    }
+    for (size_t row = 0; row < cp_df_nrows(a); ++row) {
+      int null_a = 0;
+      int null_b = 0;
+      if (cp_series_dtype(sa) == CP_DTYPE_INT64) {
+        int64_t va = 0;
+        int64_t vb = 0;
+        cp_series_get_int64(sa, row, &va, &null_a);
+        cp_series_get_int64(sb, row, &vb, &null_b);
+        if (null_a != null_b || (!null_a && va != vb)) {
+          return 0;
+        }
+      } else if (cp_series_dtype(sa) == CP_DTYPE_FLOAT64) {
+        double va = 0.0;
+        double vb = 0.0;
+        cp_series_get_float64(sa, row, &va, &null_a);
+        cp_series_get_float64(sb, row, &vb, &null_b);
+        if (null_a != null_b || (!null_a && va != vb)) {
+          return 0;
+        }
+      } else {
+        const char *va = NULL;
+        const char *vb = NULL;
+        cp_series_get_string(sa, row, &va, &null_a);
+        cp_series_get_string(sb, row, &vb, &null_b);
+        if (null_a != null_b || (!null_a && strcmp(va, vb) != 0)) {
+          return 0;
+        }
+      }
+    }
   }
+  return 1;
 }
 
-static void test_dense_float_aggregations(void) {
+static void test_text_writers_round_trip(void) {
   CpError err;
   cp_error_clear(&err);
 
-  const char *names[] = {"fval"};
-  CpDType dtypes[] = {CP_DTYPE_FLOAT64};
-  CpDataFrame *df = cp_df_create(1, names, dtypes, 0, &err);
+  const char *names[] = {"id", "value", "label"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_STRING};
+  const size_t nrows = 70000;
+  CpDataFrame *df = cp_df_create(3, names, dtypes, nrows, &err);
   CHECK(df != NULL);
   if (!df) {
     return;
   }
+  const double specials[] = {0.1,    2.7,     -0.0,   1e-5,  2.2250738585072014e-308,
+                             1e300,  -1.5e-7, 1.0 / 3.0, 9007199254740993.0,
+                             1.7976931348623157e308, 123456.789};
+  const size_t special_count = sizeof(specials) / sizeof(specials[0]);
+  uint64_t state = 88172645463325252ULL;
+  for (size_t i = 0; i < nrows; ++i) {
+    char id_buf[32];
+    char value_buf[40];
+    char label_buf[32];
+    double value = 0.0;
+    if (i < special_count) {
+      value = specials[i];
+    } else if (i % 2 == 0) {
+      value = (double)((int64_t)(i * 7919 % 100003) - 50000) / 100.0;
+    } else {
+      do {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        memcpy(&value, &state, sizeof(value));
+      } while (!isnormal(value));
+    }
+    int64_t id = i == 0 ? INT64_MIN : i == 1 ? INT64_MAX
+                                            : (int64_t)(i * 2654435761u) - 7;
+    snprintf(id_buf, sizeof(id_buf), "%lld", (long long)id);
+    snprintf(value_buf, sizeof(value_buf), "%.17g", value);
+    snprintf(label_buf, sizeof(label_buf), i % 5 == 0 ? "a\"b,%zu" : "r%zu",
+             i);
+    const char *row[] = {id_buf, value_buf, label_buf};
+    if (i % 13 == 7) {
+      row[1] = "";
+    }
+    if (!cp_df_append_row(df, row, 3, &err)) {
+      CHECK(0);
+      break;
+    }
+  }
 
-  const char *row1[] = {"1.25"};
-  const char *row2[] = {"2.5"};
-  const char *row3[] = {"-0.75"};
-  const char *row4[] = {"4.0"};
-  CHECK(cp_df_append_row(df, row1, 1, &err));
-  CHECK(cp_df_append_row(df, row2, 1, &err));
-  CHECK(cp_df_append_row(df, row3, 1, &err));
-  CHECK(cp_df_append_row(df, row4, 1, &err));
-
-  const CpSeries *fval = cp_df_get_col(df, "fval");
-  CHECK(fval != NULL);
-  if (fval) {
-    double sum = 0.0;
-    double mean = 0.0;
-    double min_val = 0.0;
-    double max_val = 0.0;
-    size_t count = 0;
-    size_t nulls = 0;
-    CHECK(cp_series_sum_float64(fval, &sum, &count, &nulls, &err));
-    CHECK(fabs(sum - 7.0) < 1e-9);
-    CHECK(count == 4);
-    CHECK(nulls == 0);
-
-    CHECK(cp_series_mean(fval, &mean, &count, &nulls, &err));
-    CHECK(fabs(mean - 1.75) < 1e-9);
-    CHECK(count == 4);
-    CHECK(nulls == 0);
-
-    CHECK(cp_series_min_float64(fval, &min_val, &nulls, &err));
-    CHECK(fabs(min_val - (-0.75)) < 1e-9);
-    CHECK(nulls == 0);
+  char *csv = make_temp_path();
+  char *ndjson = make_temp_path();
+  CHECK(csv && ndjson);
+  if (csv && ndjson) {
+    CHECK(cp_df_write_csv(df, csv, ',', 1, &err));
+    CpDataFrame *from_csv = cp_df_read_csv(csv, ',', 1, dtypes, 3, &err);
+    CHECK(from_csv != NULL);
+    if (from_csv) {
+      CHECK(csv_frames_match(df, from_csv, names, 3));
+      cp_df_free(from_csv);
+    }
+    char *contents = read_file(csv);
+    CHECK(contents != NULL);
+    if (contents) {
+      const char *head = "id,value,label\n"
+                         "-9223372036854775808,0.1,\"a\"\"b,0\"\n"
+                         "9223372036854775807,2.7,r1\n";
+      CHECK(strncmp(contents, head, strlen(head)) == 0);
+      CHECK(strstr(contents, ",-0,r2\n") != NULL);
+      CHECK(strstr(contents, ",0.00001,r3\n") != NULL);
+      free(contents);
+    }
 
-    CHECK(cp_series_max_float64(fval, &max_val, &nulls, &err));
-    CHECK(fabs(max_val - 4.0) < 1e-9);
-    CHECK(nulls == 0);
+    CHECK(cp_df_write_ndjson(df, ndjson, &err));
+    CpDataFrame *from_ndjson = cp_df_read_ndjson(ndjson, dtypes, 3, &err);
+    CHECK(from_ndjson != NULL);
+    if (from_ndjson) {
+      CHECK(csv_frames_match(df, from_ndjson, names, 3));
+      cp_df_free(from_ndjson);
+    }
+  }
+  if (csv) {
+    remove(csv);
+    free(csv);
+  }
+  if (ndjson) {
+    remove(ndjson);
+    free(ndjson);
   }
-
   cp_df_free(df);
+}
 
+static void test_parquet_read_ex(void) {
+  CpError err;
   cp_error_clear(&err);
-  CpDataFrame *nan_df = cp_df_create(1, names, dtypes, 0, &err);
-  CHECK(nan_df != NULL);
-  if (nan_df) {
-    const char *n1[] = {"1.0"};
-    const char *n2[] = {"nan"};
-    const char *n3[] = {"-2.0"};
-    CHECK(cp_df_append_row(nan_df, n1, 1, &err));
-    CHECK(cp_df_append_row(nan_df, n2, 1, &err));
-    CHECK(cp_df_append_row(nan_df, n3, 1, &err));
-
-    const CpSeries *nan_series = cp_df_get_col(nan_df, "fval");
-    CHECK(nan_series != NULL);
-    if (nan_series) {
-      double min_val = 0.0;
-      double max_val = 0.0;
-      size_t nulls = 0;
-      CHECK(cp_series_min_float64(nan_series, &min_val, &nulls, &err));
-      CHECK(fabs(min_val - (-2.0)) < 1e-9);
-      CHECK(nulls == 0);
 
-      CHECK(cp_series_max_float64(nan_series, &max_val, &nulls, &err));
-      CHECK(fabs(max_val - 1.0) < 1e-9);
-      CHECK(nulls == 0);
+  const char *names[] = {"day", "name", "val", "extra"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_STRING, CP_DTYPE_FLOAT64,
+                      CP_DTYPE_INT64};
+  size_t nrows = 200000;
+  CpDataFrame *df = cp_df_create(4, names, dtypes, nrows, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  for (size_t i = 0; i < nrows; ++i) {
+    char day[16];
+    char name[16];
+    char val[32];
+    char extra[16];
+    snprintf(day, sizeof(day), "%zu", i / 2000);
+    snprintf(name, sizeof(name), "n%03zu", i / 2000);
+    snprintf(val, sizeof(val), "%zu.5", i % 97);
+    snprintf(extra, sizeof(extra), "%zu", i * 3);
+    const char *row[4] = {day, name, i % 7 == 0 ? "" : val, extra};
+    if (!cp_df_append_row(df, row, 4, &err)) {
+      CHECK(0);
+      break;
     }
-    cp_df_free(nan_df);
   }
+  char *path = make_temp_path();
+  CHECK(path != NULL);
+  if (!path) {
+    cp_df_free(df);
+    return;
+  }
+  CHECK(cp_df_write_parquet(df, path, &err));
+
+  const char *cols[] = {"val", "day"};
+  CpParquetPredicate one_day[] = {{"day", CP_OP_EQ, "50"}};
+  CpParquetReadOptions options;
+  memset(&options, 0, sizeof(options));
+  options.columns = cols;
+  options.column_count = 2;
+  options.predicates = one_day;
+  options.predicate_count = 1;
+  CpDataFrame *pruned = cp_df_read_parquet_ex(path, &options, &err);
+  CpDataFrame *slice = cp_df_row_slice_view(df, 65536, 65536, &err);
+  CpDataFrame *expected = slice ? cp_df_select_cols(slice, cols, 2, &err)
+                                : NULL;
+  CHECK(pruned != NULL && expected != NULL);
+  if (pruned && expected) {
+    CHECK(cp_df_ncols(pruned) == 2);
+    CHECK(cp_df_nrows(pruned) == 65536);
+    CHECK(csv_frames_match(pruned, expected, cols, 2));
+  }
+
+  CpParquetPredicate late_names[] = {{"name", CP_OP_GE, "n090"}};
+  options.predicates = late_names;
+  CpDataFrame *late = cp_df_read_parquet_ex(path, &options, &err);
+  CHECK(late != NULL);
+  CHECK(late && cp_df_nrows(late) == nrows - 131072);
+
+  CpParquetPredicate none[] = {{"day", CP_OP_LT, "10"},
+                               {"day", CP_OP_GT, "80"}};
+  options.columns = NULL;
+  options.column_count = 0;
+  options.predicates = none;
+  options.predicate_count = 2;
+  CpDataFrame *empty = cp_df_read_parquet_ex(path, &options, &err);
+  CHECK(empty != NULL);
+  CHECK(empty && cp_df_nrows(empty) == 0 && cp_df_ncols(empty) == 4);
+
+  CpParquetPredicate null_day[] = {{"day", CP_OP_EQ, NULL}};
+  CpParquetPredicate null_val[] = {{"val", CP_OP_EQ, NULL}};
+  options.predicates = null_day;
+  options.predicate_count = 1;
+  CpDataFrame *no_nulls = cp_df_read_parquet_ex(path, &options, &err);
+  options.predicates = null_val;
+  CpDataFrame *with_nulls = cp_df_read_parquet_ex(path, &options, &err);
+  CHECK(no_nulls && cp_df_nrows(no_nulls) == 0);
+  CHECK(with_nulls && cp_df_nrows(with_nulls) == nrows);
+
+  CpLazyFrame *lf = cp_lazy_scan_parquet(path, &err);
+  lf = cp_lazy_filter(lf, "day == 50 and (val > 10 or val < 2)", &err);
+  const char *keep[] = {"val"};
+  lf = cp_lazy_select(lf, keep, 1, &err);
+  CpDataFrame *lazy_out = lf ? cp_lazy_collect(lf, &err) : NULL;
+  CpDataFrame *queried =
+      cp_df_query(df, "day == 50 and (val > 10 or val < 2)", &err);
+  CpDataFrame *lazy_expected =
+      queried ? cp_df_select_cols(queried, keep, 1, &err) : NULL;
+  CHECK(lazy_out != NULL && lazy_expected != NULL);
+  if (lazy_out && lazy_expected) {
+    CHECK(cp_df_nrows(lazy_out) > 0);
+    CHECK(csv_frames_match(lazy_out, lazy_expected, keep, 1));
+  }
+
+  cp_error_clear(&err);
+  CpParquetPredicate bad_value[] = {{"day", CP_OP_EQ, "abc"}};
+  options.predicates = bad_value;
+  CHECK(cp_df_read_parquet_ex(path, &options, &err) == NULL);
+  CHECK(err.code == CP_ERR_PARSE);
+  cp_error_clear(&err);
+  const char *bad_cols[] = {"day", "missing"};
+  options.columns = bad_cols;
+  options.column_count = 2;
+  options.predicates = NULL;
+  options.predicate_count = 0;
+  CHECK(cp_df_read_parquet_ex(path, &options, &err) == NULL);
+  CHECK(err.code == CP_ERR_INVALID);
+
+  cp_df_free(lazy_expected);
+  cp_df_free(queried);
+  cp_df_free(lazy_out);
+  cp_lazy_free(lf);
+  cp_df_free(with_nulls);
+  cp_df_free(no_nulls);
+  cp_df_free(empty);
+  cp_df_free(late);
+  cp_df_free(expected);
+  cp_df_free(slice);
+  cp_df_free(pruned);
+  remove(path);
+  free(path);
+  cp_df_free(df);
 }
 
-static void test_df_aggregation_helpers(void) {
+static void test_parquet_parallel_decode(void) {
   CpError err;
   cp_error_clear(&err);
 
-  const char *names[] = {"ival", "fval", "sval"};
-  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_STRING};
-  CpDataFrame *df = cp_df_create(3, names, dtypes, 0, &err);
+  const char *names[] = {"id", "x", "s", "dense"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_STRING,
+                      CP_DTYPE_INT64};
+  size_t nrows = 150000;
+  CpDataFrame *df = cp_df_create(4, names, dtypes, nrows, &err);
   CHECK(df != NULL);
   if (!df) {
     return;
   }
+  for (size_t i = 0; i < nrows; ++i) {
+    char id[16];
+    char x[32];
+    char str[16];
+    char dense[16];
+    snprintf(id, sizeof(id), "%zu", i);
+    snprintf(x, sizeof(x), "%zu.25", i % 1000);
+    snprintf(str, sizeof(str), "s%zu", i % 50);
+    snprintf(dense, sizeof(dense), "%zu", i * 7);
+    const char *row[4] = {i % 11 == 0 ? "" : id, i % 13 == 0 ? "" : x,
+                          i % 17 == 0 ? "" : str, dense};
+    if (!cp_df_append_row(df, row, 4, &err)) {
+      CHECK(0);
+      break;
+    }
+  }
+  char *path = make_temp_path();
+  CHECK(path != NULL);
+  if (!path) {
+    cp_df_free(df);
+    return;
+  }
+  CHECK(cp_df_write_parquet(df, path, &err));
+
+  CpDataFrame *full = cp_df_read_parquet(path, &err);
+  CHECK(full != NULL);
+  CHECK(full && csv_frames_match(full, df, names, 4));
+
+  CpParquetPredicate tail[] = {{"dense", CP_OP_GE, "500000"}};
+  CpParquetReadOptions options;
+  memset(&options, 0, sizeof(options));
+  options.predicates = tail;
+  options.predicate_count = 1;
+  CpDataFrame *pruned = cp_df_read_parquet_ex(path, &options, &err);
+  CpDataFrame *slice = cp_df_row_slice_view(df, 65536, nrows - 65536, &err);
+  CHECK(pruned != NULL && slice != NULL);
+  CHECK(pruned && slice && csv_frames_match(pruned, slice, names, 4));
+
+  cp_df_free(slice);
+  cp_df_free(pruned);
+  cp_df_free(full);
+  remove(path);
+  free(path);
+  cp_df_free(df);
+}
 
-  const char *row1[] = {"1", "1.5", "a"};
+static CpDataFrame *make_writer_batch(size_t first, size_t rows, int nulls) {
+  CpError err;
+  cp_error_clear(&err);
+  const char *names[] = {"id", "price", "sym"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_STRING};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, rows, &err);
+  for (size_t i = first; df && i < first + rows; ++i) {
+    char id[16];
+    char price[32];
+    char sym[16];
+    snprintf(id, sizeof(id), "%zu", i);
+    snprintf(price, sizeof(price), "%zu.5", i % 300);
+    snprintf(sym, sizeof(sym), "s%zu", i % 20);
+    const char *row[3] = {id, nulls && i % 5 == 0 ? "" : price,
+                          nulls && i % 7 == 0 ? "" : sym};
+    if (!cp_df_append_row(df, row, 3, &err)) {
+      cp_df_free(df);
+      return NULL;
+    }
+  }
+  return df;
+}
+
+static void test_parquet_writer(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "price", "sym"};
+  CpDataFrame *batches[3];
+  batches[0] = make_writer_batch(0, 1000, 0);
+  batches[1] = make_writer_batch(1000, 1000, 1);
+  batches[2] = make_writer_batch(2000, 1000, 0);
+  CHECK(batches[0] && batches[1] && batches[2]);
+  if (!batches[0] || !batches[1] || !batches[2]) {
+    cp_df_free(batches[0]);
+    cp_df_free(batches[1]);
+    cp_df_free(batches[2]);
+    return;
+  }
+  CpDataFrame *all =
+      cp_df_concat((const CpDataFrame **)batches, 3, CP_CONCAT_ROWS, &err);
+  CHECK(all != NULL);
+  char *path = make_temp_path();
+  CHECK(path != NULL);
+  if (!all || !path) {
+    cp_df_free(all);
+    free_temp_path(path);
+    cp_df_free(batches[0]);
+    cp_df_free(batches[1]);
+    cp_df_free(batches[2]);
+    return;
+  }
+
+  CpParquetWriter *writer = cp_parquet_writer_open(path, batches[0], NULL, &err);
+  CHECK(writer != NULL);
+  for (size_t i = 0; writer && i < 3; ++i) {
+    CHECK(cp_parquet_writer_write_batch(writer, batches[i], &err));
+  }
+  const char *bad_names[] = {"id", "price"};
+  CpDType bad_dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64};
+  CpDataFrame *bad = cp_df_create(2, bad_names, bad_dtypes, 0, &err);
+  cp_error_clear(&err);
+  CHECK(writer && !cp_parquet_writer_write_batch(writer, bad, &err));
+  CHECK(err.code == CP_ERR_INVALID);
+  CHECK(writer && cp_parquet_writer_close(writer, &err));
+
+  CpDataFrame *round = cp_df_read_parquet(path, &err);
+  CHECK(round != NULL);
+  CHECK(round && csv_frames_match(round, all, names, 3));
+
+  CpParquetPredicate last[] = {{"id", CP_OP_GE, "2500"}};
+  CpParquetReadOptions options;
+  memset(&options, 0, sizeof(options));
+  options.predicates = last;
+  options.predicate_count = 1;
+  CpDataFrame *pruned = cp_df_read_parquet_ex(path, &options, &err);
+  CHECK(pruned && cp_df_nrows(pruned) == 1000);
+
+  CpParquetWriterOptions writer_options;
+  writer_options.row_group_bytes = 4096;
+  writer = cp_parquet_writer_open(path, batches[0], &writer_options, &err);
+  CHECK(writer != NULL);
+  for (size_t i = 0; writer && i < 3; ++i) {
+    CHECK(cp_parquet_writer_write_batch(writer, batches[i], &err));
+  }
+  CHECK(writer && cp_parquet_writer_close(writer, &err));
+  CpDataFrame *sized = cp_df_read_parquet(path, &err);
+  CHECK(sized && csv_frames_match(sized, all, names, 3));
+  CpDataFrame *small = cp_df_read_parquet_ex(path, &options, &err);
+  CHECK(small && cp_df_nrows(small) >= 500 && cp_df_nrows(small) < 1000);
+
+  cp_df_free(small);
+  cp_df_free(sized);
+  cp_df_free(pruned);
+  cp_df_free(round);
+  cp_df_free(bad);
+  remove(path);
+  free(path);
+  cp_df_free(all);
+  cp_df_free(batches[0]);
+  cp_df_free(batches[1]);
+  cp_df_free(batches[2]);
+}
+
+static void test_cpd_mmap(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "score", "name"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_STRING};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  for (size_t i = 0; i < 1000; ++i) {
+    char id[16];
+    char score[32];
+    char name[16];
+    snprintf(id, sizeof(id), "%zu", i);
+    snprintf(score, sizeof(score), "%zu.25", i % 37);
+    snprintf(name, sizeof(name), "n%zu", i % 11);
+    const char *row[3] = {id, i % 9 == 0 ? "" : score,
+                          i % 4 == 0 ? "" : (i % 13 == 0 ? "\"\"" : name)};
+    CHECK(cp_df_append_row(df, row, 3, &err));
+  }
+  char *path = make_temp_path();
+  CHECK(path != NULL);
+  if (!path) {
+    cp_df_free(df);
+    return;
+  }
+  CHECK(cp_df_write_cpd(df, path, &err));
+
+  CpDataFrame *mapped = cp_df_open_cpd_mmap(path, &err);
+  CHECK(mapped != NULL);
+  CHECK(mapped && csv_frames_match(mapped, df, names, 3));
+  const char *row[3] = {"1", "1.0", "x"};
+  cp_error_clear(&err);
+  CHECK(mapped && !cp_df_append_row(mapped, row, 3, &err));
+  CpDataFrame *tail = mapped ? cp_df_row_slice_view(mapped, 128, 64, &err)
+                             : NULL;
+  CpDataFrame *expected_tail = cp_df_row_slice_view(df, 128, 64, &err);
+  CHECK(tail && expected_tail && csv_frames_match(tail, expected_tail, names, 3));
+  CpDataFrame *loaded = cp_df_read_cpd(path, &err);
+  CHECK(loaded && csv_frames_match(loaded, df, names, 3));
+  CHECK(loaded && cp_df_append_row(loaded, row, 3, &err));
+
+  FILE *fp = fopen(path, "r+b");
+  CHECK(fp != NULL);
+  if (fp) {
+    CHECK(fseek(fp, 40, SEEK_SET) == 0);
+    unsigned char huge[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f};
+    CHECK(fwrite(huge, 1, sizeof(huge), fp) == sizeof(huge));
+    fclose(fp);
+    cp_error_clear(&err);
+    CHECK(cp_df_open_cpd_mmap(path, &err) == NULL);
+    CHECK(err.code == CP_ERR_PARSE);
+  }
+
+  static const unsigned char legacy[] = {
+      'C', 'P', 'D', '1', 1, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
+      'x', 0,   0,   1,   7, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  fp = fopen(path, "wb");
+  CHECK(fp != NULL);
+  if (fp) {
+    CHECK(fwrite(legacy, 1, sizeof(legacy), fp) == sizeof(legacy));
+    fclose(fp);
+    CpDataFrame *old = cp_df_read_cpd(path, &err);
+    CHECK(old && cp_df_nrows(old) == 2);
+    int64_t value = 0;
+    int is_null = 0;
+    const CpSeries *x = old ? cp_df_get_col(old, "x") : NULL;
+    CHECK(x && cp_series_get_int64(x, 0, &value, &is_null));
+    CHECK(!is_null && value == 7);
+    CHECK(x && cp_series_get_int64(x, 1, &value, &is_null) && is_null);
+    cp_df_free(old);
+  }
+
+  cp_df_free(loaded);
+  cp_df_free(expected_tail);
+  cp_df_free(tail);
+  cp_df_free(mapped);
+  remove(path);
+  free(path);
+  cp_df_free(df);
+}
+
+static CpDataFrame *stream_concat(CpReader *reader,
+                                  size_t max_rows,
+                                  size_t *out_batches) {
+  CpError err;
+  cp_error_clear(&err);
+  CpDataFrame *parts[64];
+  size_t count = 0;
+  CpDataFrame *previous = NULL;
+  int ok = reader != NULL;
+  while (ok) {
+    CpDataFrame *batch = NULL;
+    ok = cp_reader_next(reader, max_rows, &batch, &err);
+    if (!ok || !batch) {
+      break;
+    }
+    if (count >= 64 || cp_df_nrows(batch) == 0 ||
+        cp_df_nrows(batch) > max_rows || (previous && batch != previous)) {
+      ok = 0;
+      break;
+    }
+    previous = batch;
+    parts[count] = cp_df_copy(batch, &err);
+    ok = parts[count] != NULL;
+    count += ok ? 1 : 0;
+  }
+  CpDataFrame *out = NULL;
+  if (ok && count > 0) {
+    CpDataFrame *batch = NULL;
+    ok = cp_reader_next(reader, max_rows, &batch, &err) && batch == NULL;
+    out = ok ? cp_df_concat((const CpDataFrame **)parts, count, CP_CONCAT_ROWS,
+                            &err)
+             : NULL;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    cp_df_free(parts[i]);
+  }
+  *out_batches = count;
+  return out;
+}
+
+static void test_reader_batches(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "score", "name"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_STRING};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  for (size_t i = 0; i < 1000; ++i) {
+    char id[16];
+    char score[32];
+    char name[16];
+    snprintf(id, sizeof(id), "%zu", i);
+    snprintf(score, sizeof(score), "%zu.5", i % 23);
+    snprintf(name, sizeof(name), "n%zu", i % 7);
+    const char *row[3] = {i % 10 == 3 ? "" : id, i % 6 == 0 ? "" : score,
+                          name};
+    CHECK(cp_df_append_row(df, row, 3, &err));
+  }
+  char *csv = make_temp_path();
+  char *ndjson = make_temp_path();
+  char *parquet = make_temp_path();
+  char *cpd = make_temp_path();
+  CHECK(csv && ndjson && parquet && cpd);
+  if (!csv || !ndjson || !parquet || !cpd) {
+    free_temp_path(csv);
+    free_temp_path(ndjson);
+    free_temp_path(parquet);
+    free_temp_path(cpd);
+    cp_df_free(df);
+    return;
+  }
+  CHECK(cp_df_write_csv(df, csv, ',', 1, &err));
+  CHECK(cp_df_write_ndjson(df, ndjson, &err));
+  CHECK(cp_df_write_cpd(df, cpd, &err));
+  CpParquetWriterOptions options;
+  options.row_group_bytes = 4096;
+  CpParquetWriter *writer = cp_parquet_writer_open(parquet, df, &options, &err);
+  CHECK(writer && cp_parquet_writer_write_batch(writer, df, &err));
+  CHECK(writer && cp_parquet_writer_close(writer, &err));
+
+  size_t batches = 0;
+  CpReader *reader =
+      cp_reader_open_csv(csv, ',', 1, dtypes, 3, NULL, 0, &err);
+  CpDataFrame *full = cp_df_read_csv(csv, ',', 1, dtypes, 3, &err);
+  CpDataFrame *streamed = stream_concat(reader, 128, &batches);
+  CHECK(full && streamed && csv_frames_match(streamed, full, names, 3));
+  CHECK(batches == 8);
+  cp_df_free(streamed);
+  cp_df_free(full);
+  cp_reader_free(reader);
+
+  reader = cp_reader_open_ndjson(ndjson, dtypes, 3, &err);
+  full = cp_df_read_ndjson(ndjson, dtypes, 3, &err);
+  streamed = stream_concat(reader, 300, &batches);
+  CHECK(full && streamed && csv_frames_match(streamed, full, names, 3));
+  CHECK(batches == 4);
+  cp_df_free(streamed);
+  cp_df_free(full);
+  cp_reader_free(reader);
+
+  reader = cp_reader_open_parquet(parquet, NULL, &err);
+  full = cp_df_read_parquet(parquet, &err);
+  streamed = stream_concat(reader, 100, &batches);
+  CHECK(full && streamed && csv_frames_match(streamed, full, names, 3));
+  CHECK(full && csv_frames_match(full, df, names, 3));
+  CHECK(batches == 10);
+  cp_df_free(streamed);
+  cp_df_free(full);
+  cp_reader_free(reader);
+
+  reader = cp_reader_open_cpd(cpd, &err);
+  streamed = stream_concat(reader, 999, &batches);
+  CHECK(streamed && csv_frames_match(streamed, df, names, 3));
+  CHECK(batches == 2);
+  cp_df_free(streamed);
+  cp_reader_free(reader);
+
+  CpDataFrame *empty = cp_df_create(3, names, dtypes, 0, &err);
+  CHECK(empty && cp_df_write_cpd(empty, cpd, &err));
+  cp_df_free(empty);
+  reader = cp_reader_open_cpd(cpd, &err);
+  CpDataFrame *batch = NULL;
+  CHECK(reader && cp_reader_next(reader, 16, &batch, &err));
+  CHECK(batch == NULL || cp_df_nrows(batch) == 0);
+  cp_df_free(batch);
+  batch = NULL;
+  cp_reader_free(reader);
+
+  CHECK(write_file(csv, "a,b\n1,2\n3\n"));
+  reader = cp_reader_open_csv(csv, ',', 1, NULL, 0, NULL, 0, &err);
+  cp_error_clear(&err);
+  CHECK(reader && !cp_reader_next(reader, 16, &batch, &err));
+  CHECK(err.code == CP_ERR_PARSE && batch == NULL);
+  cp_reader_free(reader);
+
+  remove(csv);
+  remove(ndjson);
+  remove(parquet);
+  remove(cpd);
+  free(csv);
+  free(ndjson);
+  free(parquet);
+  free(cpd);
+  cp_df_free(df);
+}
+
+static void test_read_csv_parallel(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  char *path = make_temp_path();
+  CHECK(path != NULL);
+  if (!path) {
+    return;
+  }
+
+  FILE *fp = fopen(path, "wb");
+  CHECK(fp != NULL);
+  if (!fp) {
+    free_temp_path(path);
+    return;
+  }
+  const size_t rows = 30000;
+  fputs("\nid,name,price\n", fp);
+  for (size_t i = 0; i < rows; ++i) {
+    if (i % 7 == 0) {
+      fprintf(fp, "%zu,\"a,\"\"%zu\"\"\",NA\r\n", i, i);
+    } else {
+      fprintf(fp, "%zu,n%zu,%zu.5\n", i, i % 13, i);
+    }
+    if (i % 5000 == 0) {
+      fputs("\n", fp);
+    }
+  }
+  fclose(fp);
+
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_STRING, CP_DTYPE_FLOAT64};
+  const char *na_values[] = {"NA"};
+  CpDataFrame *serial =
+      cp_df_read_csv_with_na(path, ',', 1, dtypes, 3, na_values, 1, &err);
+  CpDataFrame *parallel = cp_df_read_csv_parallel(path, ',', 1, dtypes, 3,
+                                                  na_values, 1, 4, &err);
+  CHECK(serial != NULL && parallel != NULL);
+  if (serial && parallel) {
+    const char *names[] = {"id", "name", "price"};
+    CHECK(cp_df_nrows(parallel) == rows);
+    CHECK(csv_frames_match(serial, parallel, names, 3));
+  }
+  cp_df_free(serial);
+  cp_df_free(parallel);
+
+  serial = cp_df_read_csv(path, ',', 0, NULL, 0, &err);
+  parallel = cp_df_read_csv_parallel(path, ',', 0, NULL, 0, NULL, 0, 3, &err);
+  CHECK(serial != NULL && parallel != NULL);
+  if (serial && parallel) {
+    const char *names[] = {"col0", "col1", "col2"};
+    CHECK(cp_df_nrows(parallel) == rows + 1);
+    CHECK(csv_frames_match(serial, parallel, names, 3));
+  }
+  cp_df_free(serial);
+  cp_df_free(parallel);
+
+  fp = fopen(path, "ab");
+  CHECK(fp != NULL);
+  if (fp) {
+    fputs("1,x,y\n", fp);
+    fclose(fp);
+  }
+  CpError serial_err;
+  cp_error_clear(&serial_err);
+  cp_error_clear(&err);
+  CHECK(cp_df_read_csv(path, ',', 1, dtypes, 3, &serial_err) == NULL);
+  CHECK(cp_df_read_csv_parallel(path, ',', 1, dtypes, 3, NULL, 0, 4, &err) ==
+        NULL);
+  CHECK(err.code == CP_ERR_PARSE && serial_err.code == CP_ERR_PARSE);
+  CHECK(err.row == serial_err.row && err.col == serial_err.col);
+
+  fp = fopen(path, "ab");
+  CHECK(fp != NULL);
+  if (fp) {
+    fputs("1,x\n", fp);
+    fclose(fp);
+  }
+  CpDType text_dtypes[] = {CP_DTYPE_STRING, CP_DTYPE_STRING, CP_DTYPE_STRING};
+  cp_error_clear(&serial_err);
+  cp_error_clear(&err);
+  CHECK(cp_df_read_csv(path, ',', 1, text_dtypes, 3, &serial_err) == NULL);
+  CHECK(cp_df_read_csv_parallel(path, ',', 1, text_dtypes, 3, NULL, 0, 4,
+                                &err) == NULL);
+  CHECK(err.row == serial_err.row &&
+        strcmp(err.message, serial_err.message) == 0);
+
+  remove(path);
+  free(path);
+}
+
+static void test_string_arena_sharing(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "name"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_STRING};
+  CpDataFrame *df = cp_df_create(2, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  for (size_t i = 0; i < 5000; ++i) {
+    char id_buf[32];
+    char name_buf[64];
+    snprintf(id_buf, sizeof(id_buf), "%zu", i);
+    snprintf(name_buf, sizeof(name_buf), i % 9 == 0 ? "" : "name-%zu", i);
+    const char *row[] = {id_buf, name_buf};
+    CHECK(cp_df_append_row(df, row, 2, &err));
+  }
+
+  CpDataFrame *copy = cp_df_copy(df, &err);
+  uint8_t *mask = (uint8_t *)calloc(5000, 1);
+  CHECK(copy != NULL && mask != NULL);
+  for (size_t i = 0; mask && i < 5000; i += 3) {
+    mask[i] = 1;
+  }
+  CpDataFrame *filtered = mask ? cp_df_filter_mask(df, mask, 5000, &err) : NULL;
+  CpDataFrame *head = cp_df_head_view(df, 10, &err);
+  CHECK(filtered != NULL && head != NULL);
+
+  const CpSeries *orig_name = cp_df_get_col(df, "name");
+  const CpSeries *copy_name = copy ? cp_df_get_col(copy, "name") : NULL;
+  const char *orig_val = NULL;
+  const char *copy_val = NULL;
+  int is_null = 0;
+  CHECK(cp_series_get_string(orig_name, 4, &orig_val, &is_null));
+  CHECK(cp_series_get_string(copy_name, 4, &copy_val, &is_null));
+  CHECK(orig_val == copy_val);
+
+  cp_df_free(head);
+  cp_df_free(df);
+
+  if (copy) {
+    const CpSeries *name = cp_df_get_col(copy, "name");
+    const char *value = NULL;
+    CHECK(cp_series_get_string(name, 4999, &value, &is_null));
+    CHECK(!is_null && strcmp(value, "name-4999") == 0);
+    const char *more[] = {"5000", "appended"};
+    CHECK(cp_df_append_row(copy, more, 2, &err));
+    CHECK(cp_series_get_string(name, 5000, &value, &is_null));
+    CHECK(!is_null && strcmp(value, "appended") == 0);
+  }
+  if (filtered) {
+    const CpSeries *name = cp_df_get_col(filtered, "name");
+    const char *value = NULL;
+    CHECK(cp_df_nrows(filtered) == 1667);
+    CHECK(cp_series_get_string(name, 1, &value, &is_null));
+    CHECK(!is_null && strcmp(value, "name-3") == 0);
+    CHECK(cp_series_get_string(name, 3, &value, &is_null));
+    CHECK(is_null);
+  }
+  cp_df_free(filtered);
+  cp_df_free(copy);
+  free(mask);
+}
+
+static void test_category_dtype(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  char *path = make_temp_path();
+  char *pq_path = make_temp_path();
+  CHECK(path != NULL && pq_path != NULL);
+  if (!path || !pq_path) {
+    free_temp_path(path);
+    free_temp_path(pq_path);
+    return;
+  }
+  CHECK(write_file(path,
+                   "venue,qty\n"
+                   "XNAS,10\n"
+                   "ARCA,5\n"
+                   "XNAS,7\n"
+                   ",1\n"
+                   "BATS,2\n"
+                   "ARCA,3\n"));
+  CpDType dtypes[] = {CP_DTYPE_CATEGORY, CP_DTYPE_INT64};
+  CpDataFrame *df = cp_df_read_csv(path, ',', 1, dtypes, 2, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    remove(path);
+    remove(pq_path);
+    free(path);
+    free(pq_path);
+    return;
+  }
+
+  const CpSeries *venue = cp_df_get_col(df, "venue");
+  CHECK(cp_series_dtype(venue) == CP_DTYPE_CATEGORY);
+  CHECK(cp_series_category_count(venue) == 3);
+  int32_t code = 0;
+  int is_null = 0;
+  const char *value = NULL;
+  CHECK(cp_series_get_category_code(venue, 2, &code, &is_null));
+  CHECK(!is_null && code == 0);
+  CHECK(strcmp(cp_series_category_value(venue, code), "XNAS") == 0);
+  CHECK(cp_series_get_category_code(venue, 3, &code, &is_null));
+  CHECK(is_null && code == -1);
+  CHECK(cp_series_get_string(venue, 4, &value, &is_null));
+  CHECK(!is_null && strcmp(value, "BATS") == 0);
+
+  size_t nunique = 0;
+  CHECK(cp_df_nunique(df, "venue", &nunique, &err));
+  CHECK(nunique == 3);
+
+  uint8_t mask[6];
+  CHECK(cp_df_mask_string(df, "venue", CP_OP_EQ, "ARCA", mask, 6, &err));
+  CHECK(mask[0] == 0 && mask[1] == 1 && mask[3] == 0 && mask[5] == 1);
+
+  CpDataFrame *counts = cp_df_value_counts(df, "venue", &err);
+  CHECK(counts != NULL);
+  if (counts) {
+    const CpSeries *count = cp_df_get_col(counts, "count");
+    int64_t n = 0;
+    CHECK(cp_df_nrows(counts) == 3);
+    CHECK(cp_series_get_string(cp_df_get_col(counts, "venue"), 2, &value,
+                               &is_null));
+    CHECK(strcmp(value, "BATS") == 0);
+    CHECK(cp_series_get_int64(count, 0, &n, &is_null) && n == 2);
+  }
+
+  const char *values[] = {"qty"};
+  CpAggOp ops[] = {CP_AGG_SUM};
+  CpDataFrame *grouped = cp_df_groupby_agg(df, "venue", values, ops, 1, &err);
+  CHECK(grouped != NULL);
+  if (grouped) {
+    const CpSeries *key = cp_df_get_col(grouped, "venue");
+    const CpSeries *sum = cp_df_get_col(grouped, "qty_sum");
+    int64_t total = 0;
+    CHECK(cp_df_nrows(grouped) == 3);
+    CHECK(cp_series_dtype(key) == CP_DTYPE_CATEGORY);
+    CHECK(cp_series_get_string(key, 0, &value, &is_null));
+    CHECK(strcmp(value, "XNAS") == 0);
+    CHECK(cp_series_get_int64(sum, 0, &total, &is_null) && total == 17);
+    CHECK(cp_series_get_int64(sum, 1, &total, &is_null) && total == 8);
+  }
+
+  const char *rnames[] = {"venue", "mic"};
+  CpDType rdtypes[] = {CP_DTYPE_CATEGORY, CP_DTYPE_STRING};
+  CpDataFrame *right = cp_df_create(2, rnames, rdtypes, 0, &err);
+  const char *r0[] = {"ARCA", "arca"};
+  const char *r1[] = {"XNAS", "nasdaq"};
+  CHECK(right != NULL);
+  CHECK(right && cp_df_append_row(right, r0, 2, &err));
+  CHECK(right && cp_df_append_row(right, r1, 2, &err));
+  CpDataFrame *joined =
+      right ? cp_df_join(df, right, "venue", "venue", CP_JOIN_INNER, &err)
+            : NULL;
+  CHECK(joined != NULL);
+  if (joined) {
+    CHECK(cp_df_nrows(joined) == 4);
+    CHECK(cp_series_get_string(cp_df_get_col(joined, "mic"), 1, &value,
+                               &is_null));
+    CHECK(strcmp(value, "arca") == 0);
+  }
+
+  CpDataFrame *as_str = cp_df_astype(df, "venue", CP_DTYPE_STRING, &err);
+  CHECK(as_str != NULL);
+  CpDataFrame *back =
+      as_str ? cp_df_astype(as_str, "venue", CP_DTYPE_CATEGORY, &err) : NULL;
+  CHECK(back != NULL);
+  if (back) {
+    CHECK(cp_series_category_count(cp_df_get_col(back, "venue")) == 3);
+  }
+
+  CHECK(cp_df_write_parquet(df, pq_path, &err));
+  const char *cat_cols[] = {"venue"};
+  CpDataFrame *pq = cp_df_read_parquet_categories(pq_path, cat_cols, 1, &err);
+  CHECK(pq != NULL);
+  if (pq) {
+    const CpSeries *pq_venue = cp_df_get_col(pq, "venue");
+    CHECK(cp_series_dtype(pq_venue) == CP_DTYPE_CATEGORY);
+    CHECK(cp_series_category_count(pq_venue) == 3);
+    CHECK(cp_series_get_string(pq_venue, 5, &value, &is_null));
+    CHECK(!is_null && strcmp(value, "ARCA") == 0);
+    CHECK(cp_series_get_category_code(pq_venue, 3, &code, &is_null));
+    CHECK(is_null);
+  }
+  CpDataFrame *plain = cp_df_read_parquet(pq_path, &err);
+  CHECK(plain != NULL);
+  if (plain) {
+    CHECK(cp_series_dtype(cp_df_get_col(plain, "venue")) == CP_DTYPE_STRING);
+  }
+
+  cp_df_free(plain);
+  cp_df_free(pq);
+  cp_df_free(back);
+  cp_df_free(as_str);
+  cp_df_free(joined);
+  cp_df_free(right);
+  cp_df_free(grouped);
+  cp_df_free(counts);
+  cp_df_free(df);
+  remove(path);
+  remove(pq_path);
+  free(path);
+  free(pq_path);
+}
+
+static void test_null_bitmap(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"a", "b"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64};
+  CpDataFrame *df = cp_df_create(2, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  int64_t expect_sum = 0;
+  size_t expect_nulls = 0;
+  for (int i = 0; i < 150; ++i) {
+    char a[32];
+    char b[32];
+    snprintf(a, sizeof(a), "%d", i);
+    snprintf(b, sizeof(b), "%d.5", i);
+    const char *row[2] = {i % 7 == 3 ? "" : a, i % 11 == 5 ? "" : b};
+    if (i % 7 == 3) {
+      expect_nulls += 1;
+    } else {
+      expect_sum += i;
+    }
+    CHECK(cp_df_append_row(df, row, 2, &err));
+  }
+
+  const CpSeries *a = cp_df_get_col(df, "a");
+  size_t count = 0;
+  size_t nulls = 0;
+  int64_t sum = 0;
+  CHECK(cp_series_count(a, &count, &nulls, &err));
+  CHECK(nulls == expect_nulls && count == 150 - expect_nulls);
+  CHECK(cp_series_sum_int64(a, &sum, &count, &nulls, &err));
+  CHECK(sum == expect_sum && nulls == expect_nulls);
+  int64_t min_val = 0;
+  int64_t max_val = 0;
+  CHECK(cp_series_min_int64(a, &min_val, &nulls, &err));
+  CHECK(cp_series_max_int64(a, &max_val, &nulls, &err));
+  CHECK(min_val == 0 && max_val == 149);
+
+  uint8_t mask[150];
+  CHECK(cp_df_mask_int64(df, "a", CP_OP_GE, 64, mask, 150, &err));
+  CHECK(mask[63] == 0 && mask[64] == 1 && mask[66] == 0 && mask[149] == 1);
+  CpDataFrame *filtered = cp_df_filter_int64(df, "a", CP_OP_GE, 60, &err);
+  CHECK(filtered != NULL);
+  if (filtered) {
+    CHECK(cp_df_nrows(filtered) == 78);
+    const CpSeries *fb = cp_df_get_col(filtered, "b");
+    double value = 0.0;
+    int is_null = 0;
+    CHECK(cp_series_get_float64(fb, 0, &value, &is_null));
+    CHECK(is_null);
+    CHECK(cp_series_get_float64(fb, 1, &value, &is_null));
+    CHECK(!is_null && value == 61.5);
+    cp_df_free(filtered);
+  }
+
+  CpDataFrame *tail = cp_df_tail_view(df, 83, &err);
+  CHECK(tail != NULL);
+  if (tail) {
+    const CpSeries *ta = cp_df_get_col(tail, "a");
+    int64_t value = 0;
+    int is_null = 0;
+    CHECK(cp_series_count(ta, &count, &nulls, &err));
+    CHECK(nulls == 11);
+    CHECK(cp_series_get_int64(ta, 0, &value, &is_null));
+    CHECK(!is_null && value == 67);
+    CHECK(cp_series_get_int64(ta, 6, &value, &is_null));
+    CHECK(is_null);
+    cp_df_free(tail);
+  }
+
+  char *path = make_temp_path();
+  CHECK(path != NULL);
+  if (path) {
+    CHECK(cp_df_write_cpd(df, path, &err));
+    CpDataFrame *loaded = cp_df_read_cpd(path, &err);
+    CHECK(loaded != NULL);
+    if (loaded) {
+      CHECK(cp_series_count(cp_df_get_col(loaded, "b"), &count, &nulls,
+                            &err));
+      CHECK(nulls == 14);
+      cp_df_free(loaded);
+    }
+    remove(path);
+    free(path);
+  }
+  cp_df_free(df);
+}
+
+static void test_aggregations(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"ival", "fval"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64};
+  CpDataFrame *df = cp_df_create(2, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+
+  const char *row1[] = {"1", "1.5"};
+  const char *row2[] = {"2", ""};
+  const char *row3[] = {"", "-2.25"};
+  const char *row4[] = {"-5", "0"};
+
+  CHECK(cp_df_append_row(df, row1, 2, &err));
+  CHECK(cp_df_append_row(df, row2, 2, &err));
+  CHECK(cp_df_append_row(df, row3, 2, &err));
+  CHECK(cp_df_append_row(df, row4, 2, &err));
+
+  const CpSeries *ival = cp_df_get_col(df, "ival");
+  const CpSeries *fval = cp_df_get_col(df, "fval");
+  CHECK(ival && fval);
+
+  size_t count = 0;
+  size_t nulls = 0;
+  int64_t isum = 0;
+  double fsum = 0.0;
+  double mean = 0.0;
+  int64_t imin = 0;
+  int64_t imax = 0;
+  double fmin = 0.0;
+  double fmax = 0.0;
+
+  CHECK(cp_series_count(ival, &count, &nulls, &err));
+  CHECK(count == 3 && nulls == 1);
+  CHECK(cp_series_sum_int64(ival, &isum, &count, &nulls, &err));
+  CHECK(isum == -2 && count == 3 && nulls == 1);
+  CHECK(cp_series_mean(ival, &mean, &count, &nulls, &err));
+  CHECK(fabs(mean - (-2.0 / 3.0)) < 1e-9);
+  CHECK(cp_series_min_int64(ival, &imin, &nulls, &err));
+  CHECK(imin == -5 && nulls == 1);
+  CHECK(cp_series_max_int64(ival, &imax, &nulls, &err));
+  CHECK(imax == 2 && nulls == 1);
+
+  CHECK(cp_series_count(fval, &count, &nulls, &err));
+  CHECK(count == 3 && nulls == 1);
+  CHECK(cp_series_sum_float64(fval, &fsum, &count, &nulls, &err));
+  CHECK(fabs(fsum - (-0.75)) < 1e-9 && count == 3 && nulls == 1);
+  CHECK(cp_series_mean(fval, &mean, &count, &nulls, &err));
+  CHECK(fabs(mean - (-0.25)) < 1e-9);
+  CHECK(cp_series_min_float64(fval, &fmin, &nulls, &err));
+  CHECK(fabs(fmin - (-2.25)) < 1e-9 && nulls == 1);
+  CHECK(cp_series_max_float64(fval, &fmax, &nulls, &err));
+  CHECK(fabs(fmax - 1.5) < 1e-9 && nulls == 1);
+
+  cp_df_free(df);
+
+  cp_error_clear(&err);
+  const char *null_names[] = {"empty"};
+  CpDType null_dtypes[] = {CP_DTYPE_INT64};
+  CpDataFrame *null_df = cp_df_create(1, null_names, null_dtypes, 0, &err);
+  CHECK(null_df != NULL);
+  if (null_df) {
+    const char *null_row1[] = {""};
+    const char *null_row2[] = {"   "};
+    CHECK(cp_df_append_row(null_df, null_row1, 1, &err));
+    CHECK(cp_df_append_row(null_df, null_row2, 1, &err));
+
+    const CpSeries *empty = cp_df_get_col(null_df, "empty");
+    CHECK(empty != NULL);
+
+    CHECK(!cp_series_mean(empty, NULL, NULL, NULL, &err));
+    CHECK(err.code == CP_ERR_INVALID);
+
+    cp_df_free(null_df);
+  }
+}
+
+static void test_dense_float_aggregations(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"fval"};
+  CpDType dtypes[] = {CP_DTYPE_FLOAT64};
+  CpDataFrame *df = cp_df_create(1, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+
+  const char *row1[] = {"1.25"};
+  const char *row2[] = {"2.5"};
+  const char *row3[] = {"-0.75"};
+  const char *row4[] = {"4.0"};
+  CHECK(cp_df_append_row(df, row1, 1, &err));
+  CHECK(cp_df_append_row(df, row2, 1, &err));
+  CHECK(cp_df_append_row(df, row3, 1, &err));
+  CHECK(cp_df_append_row(df, row4, 1, &err));
+
+  const CpSeries *fval = cp_df_get_col(df, "fval");
+  CHECK(fval != NULL);
+  if (fval) {
+    double sum = 0.0;
+    double mean = 0.0;
+    double min_val = 0.0;
+    double max_val = 0.0;
+    size_t count = 0;
+    size_t nulls = 0;
+    CHECK(cp_series_sum_float64(fval, &sum, &count, &nulls, &err));
+    CHECK(fabs(sum - 7.0) < 1e-9);
+    CHECK(count == 4);
+    CHECK(nulls == 0);
+
+    CHECK(cp_series_mean(fval, &mean, &count, &nulls, &err));
+    CHECK(fabs(mean - 1.75) < 1e-9);
+    CHECK(count == 4);
+    CHECK(nulls == 0);
+
+    CHECK(cp_series_min_float64(fval, &min_val, &nulls, &err));
+    CHECK(fabs(min_val - (-0.75)) < 1e-9);
+    CHECK(nulls == 0);
+
+    CHECK(cp_series_max_float64(fval, &max_val, &nulls, &err));
+    CHECK(fabs(max_val - 4.0) < 1e-9);
+    CHECK(nulls == 0);
+  }
+
+  cp_df_free(df);
+
+  cp_error_clear(&err);
+  CpDataFrame *nan_df = cp_df_create(1, names, dtypes, 0, &err);
+  CHECK(nan_df != NULL);
+  if (nan_df) {
+    const char *n1[] = {"1.0"};
+    const char *n2[] = {"nan"};
+    const char *n3[] = {"-2.0"};
+    CHECK(cp_df_append_row(nan_df, n1, 1, &err));
+    CHECK(cp_df_append_row(nan_df, n2, 1, &err));
+    CHECK(cp_df_append_row(nan_df, n3, 1, &err));
+
+    const CpSeries *nan_series = cp_df_get_col(nan_df, "fval");
+    CHECK(nan_series != NULL);
+    if (nan_series) {
+      double min_val = 0.0;
+      double max_val = 0.0;
+      size_t nulls = 0;
+      CHECK(cp_series_min_float64(nan_series, &min_val, &nulls, &err));
+      CHECK(fabs(min_val - (-2.0)) < 1e-9);
+      CHECK(nulls == 0);
+
+      CHECK(cp_series_max_float64(nan_series, &max_val, &nulls, &err));
+      CHECK(fabs(max_val - 1.0) < 1e-9);
+      CHECK(nulls == 0);
+    }
+    cp_df_free(nan_df);
+  }
+}
+
+static void test_df_aggregation_helpers(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"ival", "fval", "sval"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_STRING};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+
+  const char *row1[] = {"1", "1.5", "a"};
   const char *row2[] = {"2", "", ""};
   const char *row3[] = {"-5", "-2.25", "b"};
   const char *row4[] = {"", "0", ""};
@@ -2200,6 +3411,81 @@ static void test_sort_values_multi(void) {
   cp_df_free(df);
 }
 
+static void test_sort_radix(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"row", "k", "f", "c", "tie"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_INT64, CP_DTYPE_FLOAT64,
+                      CP_DTYPE_CATEGORY, CP_DTYPE_STRING};
+  CpDataFrame *df = cp_df_create(5, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  const char *floats[] = {"-0.0", "0.0", "nan", "-1.5", "2.25", "inf",
+                          "-inf", "", "1e300", "-1e-300"};
+  const char *cats[] = {"pear", "apple", "", "fig", "banana"};
+  for (int i = 0; i < 3000; ++i) {
+    char row[32];
+    char k[32];
+    snprintf(row, sizeof(row), "%d", i);
+    snprintf(k, sizeof(k), "%lld",
+             (long long)((i * 7919) % 23 - 11) * 400000000000000000LL);
+    const char *values[5] = {row, i % 53 == 5 ? "" : k,
+                             floats[(i * 31) % 10], cats[(i * 13) % 5], "x"};
+    CHECK(cp_df_append_row(df, values, 5, &err));
+  }
+
+  const char *key_sets[][4] = {{"k", "tie"},
+                               {"f", "tie"},
+                               {"c", "k", "tie"},
+                               {"f", "c", "k", "tie"}};
+  size_t key_counts[] = {1, 1, 2, 3};
+  int asc_sets[][4] = {{1, 1}, {0, 1}, {1, 0, 1}, {0, 1, 0, 1}};
+  for (size_t set = 0; set < 4; ++set) {
+    CpDataFrame *radix = cp_df_sort_values_multi(
+        df, key_sets[set], key_counts[set], asc_sets[set], &err);
+    CpDataFrame *merge = cp_df_sort_values_multi(
+        df, key_sets[set], key_counts[set] + 1, asc_sets[set], &err);
+    CHECK(radix != NULL && merge != NULL);
+    if (radix && merge) {
+      CHECK(cp_df_nrows(radix) == 3000);
+      const CpSeries *a = cp_df_get_col(radix, "row");
+      const CpSeries *b = cp_df_get_col(merge, "row");
+      int same = 1;
+      for (size_t i = 0; i < 3000; ++i) {
+        int64_t av = 0;
+        int64_t bv = 0;
+        int is_null = 0;
+        CHECK(cp_series_get_int64(a, i, &av, &is_null));
+        CHECK(cp_series_get_int64(b, i, &bv, &is_null));
+        same = same && av == bv;
+      }
+      CHECK(same);
+    }
+    cp_df_free(radix);
+    cp_df_free(merge);
+  }
+
+  const char *by_f[] = {"f"};
+  int desc[] = {0};
+  CpDataFrame *sorted = cp_df_sort_values_multi(df, by_f, 1, desc, &err);
+  CHECK(sorted != NULL);
+  if (sorted) {
+    const CpSeries *f = cp_df_get_col(sorted, "f");
+    double value = 0.0;
+    int is_null = 0;
+    CHECK(cp_series_get_float64(f, 0, &value, &is_null));
+    CHECK(!is_null && isnan(value));
+    CHECK(cp_series_get_float64(f, 2999, &value, &is_null));
+    CHECK(is_null);
+    cp_df_free(sorted);
+  }
+
+  cp_df_free(df);
+}
+
 static void test_head_tail(void) {
   CpError err;
   cp_error_clear(&err);
@@ -3230,6 +4516,71 @@ static void test_nlargest_nsmallest(void) {
   cp_df_free(df);
 }
 
+static void test_nlargest_keep(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "score"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_INT64};
+  CpDataFrame *df = cp_df_create(2, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  const char *scores[] = {"5", "3", "5", "", "2", "5", "1"};
+  for (int i = 0; i < 7; ++i) {
+    char id[16];
+    snprintf(id, sizeof(id), "%d", i + 1);
+    const char *row[2] = {id, scores[i]};
+    CHECK(cp_df_append_row(df, row, 2, &err));
+  }
+
+  CpNSelectKeep keeps[] = {CP_NSELECT_KEEP_FIRST, CP_NSELECT_KEEP_LAST,
+                           CP_NSELECT_KEEP_ALL};
+  int64_t want_largest[3][3] = {{1, 3, 0}, {6, 3, 0}, {1, 3, 6}};
+  size_t want_counts[] = {2, 2, 3};
+  for (size_t k = 0; k < 3; ++k) {
+    CpDataFrame *top = cp_df_nlargest_keep(df, "score", 2, keeps[k], &err);
+    CHECK(top != NULL);
+    if (!top) {
+      continue;
+    }
+    CHECK(cp_df_nrows(top) == want_counts[k]);
+    const CpSeries *id = cp_df_get_col(top, "id");
+    for (size_t i = 0; i < want_counts[k] && i < cp_df_nrows(top); ++i) {
+      int64_t value = 0;
+      int is_null = 0;
+      CHECK(cp_series_get_int64(id, i, &value, &is_null));
+      CHECK(!is_null && value == want_largest[k][i]);
+    }
+    cp_df_free(top);
+  }
+
+  CpDataFrame *bottom =
+      cp_df_nsmallest_keep(df, "score", 4, CP_NSELECT_KEEP_ALL, &err);
+  CHECK(bottom != NULL);
+  if (bottom) {
+    CHECK(cp_df_nrows(bottom) == 6);
+    const CpSeries *id = cp_df_get_col(bottom, "id");
+    int64_t want[] = {7, 5, 2, 1, 3, 6};
+    for (size_t i = 0; i < 6 && i < cp_df_nrows(bottom); ++i) {
+      int64_t value = 0;
+      int is_null = 0;
+      CHECK(cp_series_get_int64(id, i, &value, &is_null));
+      CHECK(!is_null && value == want[i]);
+    }
+    cp_df_free(bottom);
+  }
+
+  cp_error_clear(&err);
+  CpDataFrame *bad =
+      cp_df_nlargest_keep(df, "score", 2, (CpNSelectKeep)7, &err);
+  CHECK(bad == NULL);
+  CHECK(err.code == CP_ERR_INVALID);
+
+  cp_df_free(df);
+}
+
 static void test_where_mask_clip_replace(void) {
   CpError err;
   cp_error_clear(&err);
@@ -3618,6 +4969,73 @@ static void test_apply_transform_iter(void) {
   cp_df_free(df);
 }
 
+static void test_apply_transform_batch(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "score", "tag"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_STRING};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  for (size_t i = 0; i < 10000; ++i) {
+    char id_buf[32];
+    char score_buf[32];
+    char tag_buf[32];
+    snprintf(id_buf, sizeof(id_buf), "%zu", i);
+    snprintf(score_buf, sizeof(score_buf), "%zu.5", i % 97);
+    snprintf(tag_buf, sizeof(tag_buf), "t%zu", i % 5);
+    const char *row[] = {id_buf, i % 131 == 7 ? "" : score_buf, tag_buf};
+    CHECK(cp_df_append_row(df, row, 3, &err));
+  }
+
+  ApplySumCtx apply_ctx = {0};
+  apply_ctx.id = cp_df_get_col(df, "id");
+  apply_ctx.score = cp_df_get_col(df, "score");
+  CpDataFrame *expected =
+      cp_df_apply(df, CP_DTYPE_INT64, "sum", apply_sum_row, &apply_ctx, &err);
+  CpDataFrame *expected_t = cp_df_transform(df, "score", CP_DTYPE_FLOAT64,
+                                            transform_double, NULL, &err);
+  CHECK(expected != NULL && expected_t != NULL);
+  const char *sum_names[] = {"sum"};
+  const char *all_names[] = {"id", "score", "tag"};
+  for (int thread_safe = 0; thread_safe <= 1; ++thread_safe) {
+    CpDataFrame *applied =
+        cp_df_apply_batch(df, CP_DTYPE_INT64, "sum", apply_sum_batch, NULL,
+                          1000, thread_safe, &err);
+    CHECK(applied != NULL);
+    if (applied && expected) {
+      CHECK(csv_frames_match(applied, expected, sum_names, 1));
+    }
+    CpDataFrame *transformed =
+        cp_df_transform_batch(df, "score", CP_DTYPE_FLOAT64,
+                              transform_double_batch, NULL, 0, thread_safe,
+                              &err);
+    CHECK(transformed != NULL);
+    if (transformed && expected_t) {
+      CHECK(csv_frames_match(transformed, expected_t, all_names, 3));
+    }
+    cp_df_free(applied);
+    cp_df_free(transformed);
+
+    size_t fail_from = 5000;
+    cp_error_clear(&err);
+    CHECK(cp_df_apply_batch(df, CP_DTYPE_INT64, "sum", apply_fail_batch,
+                            &fail_from, 1024, thread_safe, &err) == NULL);
+    CHECK(err.code == CP_ERR_INVALID && err.row == 5120);
+  }
+  cp_error_clear(&err);
+  CHECK(cp_df_apply_batch(df, CP_DTYPE_STRING, "sum", apply_sum_batch, NULL,
+                          0, 0, &err) == NULL);
+  CHECK(err.code == CP_ERR_INVALID);
+
+  cp_df_free(expected);
+  cp_df_free(expected_t);
+  cp_df_free(df);
+}
+
 static void test_astype_index_at(void) {
   CpError err;
   cp_error_clear(&err);
@@ -4160,7 +5578,7 @@ static void test_info_describe(void) {
   CpDataFrame *desc = cp_df_describe(df, &err);
   CHECK(desc != NULL);
   if (desc) {
-    CHECK(cp_df_nrows(desc) == 4);
+    CHECK(cp_df_nrows(desc) == 8);
     CHECK(cp_df_ncols(desc) == 3);
     const CpSeries *stat = cp_df_get_col(desc, "stat");
     const CpSeries *id = cp_df_get_col(desc, "id");
@@ -4171,28 +5589,130 @@ static void test_info_describe(void) {
     double val = 0.0;
     int is_null = 0;
 
-    CHECK(cp_series_get_string(stat, 0, &stat_val, &is_null));
-    CHECK(!is_null && strcmp(stat_val, "count") == 0);
-    CHECK(cp_series_get_float64(id, 0, &val, &is_null));
-    CHECK(!is_null && fabs(val - 2.0) < 1e-9);
+    CHECK(cp_series_get_string(stat, 0, &stat_val, &is_null));
+    CHECK(!is_null && strcmp(stat_val, "count") == 0);
+    CHECK(cp_series_get_float64(id, 0, &val, &is_null));
+    CHECK(!is_null && fabs(val - 2.0) < 1e-9);
+
+    CHECK(cp_series_get_string(stat, 1, &stat_val, &is_null));
+    CHECK(!is_null && strcmp(stat_val, "mean") == 0);
+    CHECK(cp_series_get_float64(id, 1, &val, &is_null));
+    CHECK(!is_null && fabs(val - 1.5) < 1e-9);
+
+    CHECK(cp_series_get_string(stat, 3, &stat_val, &is_null));
+    CHECK(!is_null && strcmp(stat_val, "min") == 0);
+    CHECK(cp_series_get_float64(score, 3, &val, &is_null));
+    CHECK(!is_null && fabs(val - (-1.0)) < 1e-9);
+
+    CHECK(cp_series_get_string(stat, 7, &stat_val, &is_null));
+    CHECK(!is_null && strcmp(stat_val, "max") == 0);
+    CHECK(cp_series_get_float64(score, 7, &val, &is_null));
+    CHECK(!is_null && fabs(val - 3.0) < 1e-9);
+
+    CHECK(cp_series_get_string(stat, 2, &stat_val, &is_null));
+    CHECK(!is_null && strcmp(stat_val, "std") == 0);
+    CHECK(cp_series_get_float64(score, 2, &val, &is_null));
+    CHECK(!is_null && fabs(val - sqrt(13.0 / 3.0)) < 1e-9);
+    CHECK(cp_series_get_float64(score, 4, &val, &is_null));
+    CHECK(!is_null && fabs(val - 0.5) < 1e-9);
+    CHECK(cp_series_get_float64(score, 5, &val, &is_null));
+    CHECK(!is_null && fabs(val - 2.0) < 1e-9);
+    CHECK(cp_series_get_float64(id, 6, &val, &is_null));
+    CHECK(!is_null && fabs(val - 1.75) < 1e-9);
+  }
+
+  cp_df_free(desc);
+  cp_df_free(df);
+
+  const char *nan_names[] = {"x"};
+  CpDType nan_dtypes[] = {CP_DTYPE_FLOAT64};
+  CpDataFrame *nan_df = cp_df_create(1, nan_names, nan_dtypes, 0, &err);
+  CHECK(nan_df != NULL);
+  if (!nan_df) {
+    return;
+  }
+  const char *nan_rows[] = {"1.5", "nan", "", "4", "nan"};
+  for (size_t i = 0; i < 5; ++i) {
+    CHECK(cp_df_append_row(nan_df, &nan_rows[i], 1, &err));
+  }
+  const CpSeries *x = cp_df_get_col(nan_df, "x");
+  size_t want_count = 0;
+  double want_mean = 0.0;
+  CHECK(cp_series_count(x, &want_count, NULL, &err) && want_count == 4);
+  CHECK(cp_series_mean(x, &want_mean, NULL, NULL, &err) && isnan(want_mean));
+  CpDataFrame *nan_desc = cp_df_describe(nan_df, &err);
+  CHECK(nan_desc != NULL);
+  if (nan_desc) {
+    const CpSeries *col = cp_df_get_col(nan_desc, "x");
+    double count = 0.0;
+    double mean = 0.0;
+    double min_val = 0.0;
+    double max_val = 0.0;
+    CHECK(cp_series_get_float64(col, 0, &count, NULL) && count == 4.0);
+    CHECK(cp_series_get_float64(col, 1, &mean, NULL) && isnan(mean));
+    CHECK(cp_series_get_float64(col, 3, &min_val, NULL) && min_val == 1.5);
+    CHECK(cp_series_get_float64(col, 7, &max_val, NULL) && max_val == 4.0);
+    cp_df_free(nan_desc);
+  }
+  cp_df_free(nan_df);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double av = *(const double *)a;
+  double bv = *(const double *)b;
+  return av < bv ? -1 : (av > bv ? 1 : 0);
+}
 
-    CHECK(cp_series_get_string(stat, 1, &stat_val, &is_null));
-    CHECK(!is_null && strcmp(stat_val, "mean") == 0);
-    CHECK(cp_series_get_float64(id, 1, &val, &is_null));
-    CHECK(!is_null && fabs(val - 1.5) < 1e-9);
+static void test_series_quantile(void) {
+  CpError err;
+  cp_error_clear(&err);
 
-    CHECK(cp_series_get_string(stat, 2, &stat_val, &is_null));
-    CHECK(!is_null && strcmp(stat_val, "min") == 0);
-    CHECK(cp_series_get_float64(score, 2, &val, &is_null));
-    CHECK(!is_null && fabs(val - (-1.0)) < 1e-9);
+  const char *names[] = {"value"};
+  CpDType dtypes[] = {CP_DTYPE_FLOAT64};
+  CpDataFrame *df = cp_df_create(1, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  double sorted[1000];
+  size_t count = 0;
+  for (size_t i = 0; i < 1200; ++i) {
+    char buf[32];
+    const char *row[] = {buf};
+    if (i % 6 == 5) {
+      row[0] = i % 12 == 5 ? "" : "nan";
+    } else {
+      double value = (double)((i * 7919) % 257) - (double)(i % 3) * 0.5;
+      snprintf(buf, sizeof(buf), "%.1f", value);
+      sorted[count++] = value;
+    }
+    CHECK(cp_df_append_row(df, row, 1, &err));
+  }
+  qsort(sorted, count, sizeof(double), compare_doubles);
 
-    CHECK(cp_series_get_string(stat, 3, &stat_val, &is_null));
-    CHECK(!is_null && strcmp(stat_val, "max") == 0);
-    CHECK(cp_series_get_float64(score, 3, &val, &is_null));
-    CHECK(!is_null && fabs(val - 3.0) < 1e-9);
+  const double qs[] = {0.9, 0.0, 0.5, 0.333, 1.0, 0.5};
+  double out[6];
+  CHECK(cp_df_quantile(df, "value", qs, 6, out, &err));
+  int ok = 1;
+  for (size_t i = 0; i < 6; ++i) {
+    double pos = qs[i] * (double)(count - 1);
+    size_t lo = (size_t)pos;
+    double expected = sorted[lo];
+    if (lo + 1 < count) {
+      expected += (sorted[lo + 1] - sorted[lo]) * (pos - (double)lo);
+    }
+    ok &= fabs(out[i] - expected) < 1e-9;
   }
+  CHECK(ok);
 
-  cp_df_free(desc);
+  double median = 0.0;
+  CHECK(cp_df_median(df, "value", &median, NULL, NULL, &err));
+  CHECK(fabs(median - (sorted[count / 2 - 1] + sorted[count / 2]) / 2.0) <
+        1e-9);
+
+  const double bad[] = {1.5};
+  CHECK(!cp_df_quantile(df, "value", bad, 1, out, &err));
+  CHECK(err.code == CP_ERR_INVALID);
   cp_df_free(df);
 }
 
@@ -4468,6 +5988,81 @@ static void test_multi_index_loc(void) {
   cp_df_free(df);
 }
 
+static void test_row_index_lookup(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"key", "id", "value"};
+  CpDType dtypes[] = {CP_DTYPE_STRING, CP_DTYPE_INT64, CP_DTYPE_INT64};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  for (size_t i = 0; i < 20000; ++i) {
+    char key[32];
+    char id[32];
+    char value[32];
+    snprintf(key, sizeof(key), "k%zu", i % 5000);
+    snprintf(id, sizeof(id), "%zu", i);
+    snprintf(value, sizeof(value), "%zu", i * 3);
+    const char *row[3] = {i == 7 ? "" : key, i == 9 ? "" : id, value};
+    CHECK(cp_df_append_row(df, row, 3, &err));
+  }
+
+  CpDataFrame *by_id = cp_df_set_index(df, "id", &err);
+  CHECK(by_id != NULL);
+  int64_t v = 0;
+  int is_null = 0;
+  CHECK(by_id && cp_df_at_int64(by_id, "12345", "value", &v, &is_null, &err));
+  CHECK(!is_null && v == 12345 * 3);
+  cp_error_clear(&err);
+  CHECK(by_id && !cp_df_at_int64(by_id, "9", "value", &v, &is_null, &err));
+  CHECK(err.code == CP_ERR_INVALID);
+  const char *append[3] = {"k-new", "77777", "5"};
+  CHECK(by_id && cp_df_append_row(by_id, append, 3, &err));
+  CHECK(by_id && cp_df_at_int64(by_id, "77777", "value", &v, &is_null, &err));
+  CHECK(!is_null && v == 5);
+
+  CpDataFrame *by_key = cp_df_set_index(df, "key", &err);
+  CHECK(by_key && cp_df_at_int64(by_key, "k42", "value", &v, &is_null, &err));
+  CHECK(!is_null && v == 42 * 3);
+  CpDataFrame *slice =
+      by_key ? cp_df_loc_slice(by_key, "k10", "k12", NULL, 0, &err) : NULL;
+  CHECK(slice && cp_df_nrows(slice) == 3);
+
+  const char *multi[] = {"key", "id"};
+  CpDataFrame *by_both = cp_df_set_index_multi(df, multi, 2, &err);
+  CHECK(by_both &&
+        cp_df_at_int64(by_both, "k17|10017", "value", &v, &is_null, &err));
+  CHECK(!is_null && v == 10017 * 3);
+  CpValue levels[2];
+  memset(levels, 0, sizeof(levels));
+  levels[0].value.str = "k17";
+  levels[1].value.i64 = 15017;
+  size_t row = 0;
+  CHECK(by_both && cp_df_find_row(by_both, levels, 2, &row, &err));
+  CHECK(row == 15017);
+  levels[1].value.i64 = 15018;
+  cp_error_clear(&err);
+  CHECK(by_both && !cp_df_find_row(by_both, levels, 2, &row, &err));
+  CHECK(err.code == CP_ERR_INVALID);
+  cp_error_clear(&err);
+  CHECK(by_both && !cp_df_find_row(by_both, levels, 1, &row, &err));
+  CHECK(err.code == CP_ERR_INVALID);
+
+  CpValue position;
+  memset(&position, 0, sizeof(position));
+  position.value.i64 = 3;
+  CHECK(cp_df_find_row(df, &position, 1, &row, &err) && row == 3);
+
+  cp_df_free(slice);
+  cp_df_free(by_both);
+  cp_df_free(by_key);
+  cp_df_free(by_id);
+  cp_df_free(df);
+}
+
 static void test_groupby_agg(void) {
   CpError err;
   cp_error_clear(&err);
@@ -4609,6 +6204,401 @@ static void test_groupby_agg(void) {
   cp_df_free(df2);
 }
 
+static void test_groupby_agg_many_groups(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "symbol", "qty"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_STRING, CP_DTYPE_INT64};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+
+  const size_t groups = 1500;
+  for (size_t pass = 0; pass < 3; ++pass) {
+    for (size_t i = 0; i < groups; ++i) {
+      size_t key = (i * 7919) % groups;
+      char id_buf[32];
+      char sym_buf[32];
+      char qty_buf[32];
+      snprintf(id_buf, sizeof(id_buf), "%zu", key);
+      snprintf(sym_buf, sizeof(sym_buf), "S%zu", key);
+      snprintf(qty_buf, sizeof(qty_buf), "%zu", key + pass);
+      const char *row[] = {id_buf, sym_buf, qty_buf};
+      CHECK(cp_df_append_row(df, row, 3, &err));
+    }
+  }
+  const char *null_row[] = {"", "", "5"};
+  CHECK(cp_df_append_row(df, null_row, 3, &err));
+
+  const char *value_cols[] = {"qty", "qty"};
+  CpAggOp ops[] = {CP_AGG_SUM, CP_AGG_COUNT};
+  CpDataFrame *by_id = cp_df_groupby_agg(df, "id", value_cols, ops, 2, &err);
+  CHECK(by_id != NULL);
+  if (by_id) {
+    CHECK(cp_df_nrows(by_id) == groups);
+    const CpSeries *id = cp_df_get_col(by_id, "id");
+    const CpSeries *sum = cp_df_get_col(by_id, "qty_sum");
+    const CpSeries *cnt = cp_df_get_col(by_id, "qty_count");
+    CHECK(id && sum && cnt);
+    int ok = 1;
+    for (size_t g = 0; id && sum && cnt && g < groups; ++g) {
+      int64_t key = 0;
+      int64_t total = 0;
+      int64_t n = 0;
+      int is_null = 0;
+      cp_series_get_int64(id, g, &key, &is_null);
+      cp_series_get_int64(sum, g, &total, &is_null);
+      cp_series_get_int64(cnt, g, &n, &is_null);
+      if (key != (int64_t)((g * 7919) % groups) || total != key * 3 + 3 ||
+          n != 3) {
+        ok = 0;
+      }
+    }
+    CHECK(ok);
+    cp_df_free(by_id);
+  }
+
+  CpDataFrame *by_sym =
+      cp_df_groupby_agg(df, "symbol", value_cols, ops, 2, &err);
+  CHECK(by_sym != NULL);
+  if (by_sym) {
+    CHECK(cp_df_nrows(by_sym) == groups);
+    const CpSeries *sym = cp_df_get_col(by_sym, "symbol");
+    const CpSeries *sum = cp_df_get_col(by_sym, "qty_sum");
+    CHECK(sym && sum);
+    const char *value = NULL;
+    int64_t total = 0;
+    int is_null = 0;
+    CHECK(cp_series_get_string(sym, 1, &value, &is_null));
+    CHECK(!is_null && strcmp(value, "S419") == 0);
+    CHECK(cp_series_get_int64(sum, 1, &total, &is_null));
+    CHECK(!is_null && total == 419 * 3 + 3);
+    cp_df_free(by_sym);
+  }
+
+  cp_df_free(df);
+}
+
+static void test_groupby_agg_multi(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"region", "year", "sales"};
+  CpDType dtypes[] = {CP_DTYPE_STRING, CP_DTYPE_INT64, CP_DTYPE_FLOAT64};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+
+  const char *rows[][3] = {
+      {"east", "2020", "1.5"}, {"west", "2020", "2.0"},
+      {"east", "2021", "3.0"}, {"east", "2020", "4.5"},
+      {"", "2020", "9.0"},     {"west", "", "9.0"},
+      {"west", "2020", "1.0"},
+  };
+  for (size_t i = 0; i < sizeof(rows) / sizeof(rows[0]); ++i) {
+    CHECK(cp_df_append_row(df, rows[i], 3, &err));
+  }
+
+  const char *keys[] = {"region", "year"};
+  const char *value_cols[] = {"sales", "sales"};
+  CpAggOp ops[] = {CP_AGG_SUM, CP_AGG_COUNT};
+  CpDataFrame *grouped =
+      cp_df_groupby_agg_multi(df, keys, 2, value_cols, ops, 2, &err);
+  CHECK(grouped != NULL);
+  if (grouped) {
+    CHECK(cp_df_nrows(grouped) == 3);
+    CHECK(cp_df_ncols(grouped) == 4);
+    const CpSeries *region = cp_df_get_col(grouped, "region");
+    const CpSeries *year = cp_df_get_col(grouped, "year");
+    const CpSeries *sum = cp_df_get_col(grouped, "sales_sum");
+    const CpSeries *cnt = cp_df_get_col(grouped, "sales_count");
+    CHECK(region && year && sum && cnt);
+    const char *expected_region[] = {"east", "west", "east"};
+    int64_t expected_year[] = {2020, 2020, 2021};
+    double expected_sum[] = {6.0, 3.0, 3.0};
+    int64_t expected_count[] = {2, 2, 1};
+    for (size_t g = 0; region && year && sum && cnt && g < 3; ++g) {
+      const char *region_val = NULL;
+      int64_t year_val = 0;
+      double sum_val = 0.0;
+      int64_t count_val = 0;
+      int is_null = 0;
+      CHECK(cp_series_get_string(region, g, &region_val, &is_null));
+      CHECK(!is_null && strcmp(region_val, expected_region[g]) == 0);
+      CHECK(cp_series_get_int64(year, g, &year_val, &is_null));
+      CHECK(!is_null && year_val == expected_year[g]);
+      CHECK(cp_series_get_float64(sum, g, &sum_val, &is_null));
+      CHECK(!is_null && fabs(sum_val - expected_sum[g]) < 1e-9);
+      CHECK(cp_series_get_int64(cnt, g, &count_val, &is_null));
+      CHECK(!is_null && count_val == expected_count[g]);
+    }
+    cp_df_free(grouped);
+  }
+
+  const char *bad_keys[] = {"region", "sales"};
+  cp_error_clear(&err);
+  CHECK(cp_df_groupby_agg_multi(df, bad_keys, 2, value_cols, ops, 2, &err) ==
+        NULL);
+  CHECK(err.code == CP_ERR_INVALID);
+
+  cp_df_free(df);
+}
+
+static void test_groupby_agg_large(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "qty", "price"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_INT64, CP_DTYPE_FLOAT64};
+  const size_t rows = (size_t)(1u << 18) + 4096;
+  const size_t groups = 977;
+  CpDataFrame *df = cp_df_create(3, names, dtypes, rows, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  for (size_t i = 0; i < rows; ++i) {
+    char id_buf[32];
+    char qty_buf[32];
+    char price_buf[32];
+    snprintf(id_buf, sizeof(id_buf), "%zu", (groups - 1) - (i % groups));
+    snprintf(qty_buf, sizeof(qty_buf), "%zu", i % 7);
+    snprintf(price_buf, sizeof(price_buf), "%zu.5", i % 3);
+    const char *row[] = {id_buf, qty_buf, price_buf};
+    if (!cp_df_append_row(df, row, 3, &err)) {
+      CHECK(0);
+      break;
+    }
+  }
+
+  const char *value_cols[] = {"qty", "qty", "price", "price", "qty"};
+  CpAggOp ops[] = {CP_AGG_SUM, CP_AGG_COUNT, CP_AGG_MIN, CP_AGG_MAX,
+                   CP_AGG_MEAN};
+  CpDataFrame *grouped =
+      cp_df_groupby_agg(df, "id", value_cols, ops, 5, &err);
+  CHECK(grouped != NULL);
+  if (grouped) {
+    CHECK(cp_df_nrows(grouped) == groups);
+    const CpSeries *id = cp_df_get_col(grouped, "id");
+    const CpSeries *sum = cp_df_get_col(grouped, "qty_sum");
+    const CpSeries *cnt = cp_df_get_col(grouped, "qty_count");
+    const CpSeries *min = cp_df_get_col(grouped, "price_min");
+    const CpSeries *max = cp_df_get_col(grouped, "price_max");
+    CHECK(id && sum && cnt && min && max);
+    int ok = 1;
+    for (size_t g = 0; id && sum && cnt && min && max && g < groups; ++g) {
+      int64_t expected_sum = 0;
+      int64_t expected_count = 0;
+      for (size_t i = g; i < rows; i += groups) {
+        expected_sum += (int64_t)(i % 7);
+        expected_count += 1;
+      }
+      int64_t key = 0;
+      int64_t total = 0;
+      int64_t n = 0;
+      double lo = 0.0;
+      double hi = 0.0;
+      int is_null = 0;
+      cp_series_get_int64(id, g, &key, &is_null);
+      cp_series_get_int64(sum, g, &total, &is_null);
+      cp_series_get_int64(cnt, g, &n, &is_null);
+      cp_series_get_float64(min, g, &lo, &is_null);
+      cp_series_get_float64(max, g, &hi, &is_null);
+      if (key != (int64_t)(groups - 1 - g) || total != expected_sum ||
+          n != expected_count || fabs(lo - 0.5) > 1e-9 ||
+          fabs(hi - 2.5) > 1e-9) {
+        ok = 0;
+      }
+    }
+    CHECK(ok);
+    cp_df_free(grouped);
+  }
+
+  cp_df_free(df);
+}
+
+static void test_groupby_agg_merge_overflow(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "qty"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_INT64};
+  const size_t rows = (size_t)1u << 18;
+  CpDataFrame *df = cp_df_create(2, names, dtypes, rows, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  /* Any partition of up to half the rows fits in int64; the total does not. */
+  char qty_buf[32];
+  snprintf(qty_buf, sizeof(qty_buf), "%lld",
+           (long long)(INT64_MAX / (int64_t)(rows / 2)));
+  for (size_t i = 0; i < rows; ++i) {
+    const char *row[] = {"1", qty_buf};
+    if (!cp_df_append_row(df, row, 2, &err)) {
+      CHECK(0);
+      break;
+    }
+  }
+
+  const char *value_cols[] = {"qty"};
+  CpAggOp ops[] = {CP_AGG_SUM};
+  cp_error_clear(&err);
+  CpDataFrame *grouped = cp_df_groupby_agg(df, "id", value_cols, ops, 1, &err);
+  CHECK(grouped == NULL);
+  CHECK(strcmp(err.message, "int64 sum overflow") == 0);
+  cp_df_free(grouped);
+  cp_df_free(df);
+}
+
+static void test_groupby_state_stream(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"sym", "day", "qty", "price"};
+  CpDType dtypes[] = {CP_DTYPE_STRING, CP_DTYPE_INT64, CP_DTYPE_INT64,
+                      CP_DTYPE_FLOAT64};
+  CpDataFrame *full = cp_df_create(4, names, dtypes, 0, &err);
+  CpDataFrame *batches[4] = {NULL, NULL, NULL, NULL};
+  for (size_t b = 0; b < 4; ++b) {
+    batches[b] = cp_df_create(4, names, dtypes, 0, &err);
+    CHECK(batches[b] != NULL);
+  }
+  CHECK(full != NULL);
+  if (!full || !batches[0] || !batches[1] || !batches[2] || !batches[3]) {
+    cp_df_free(full);
+    for (size_t b = 0; b < 4; ++b) {
+      cp_df_free(batches[b]);
+    }
+    return;
+  }
+  for (size_t i = 0; i < 400; ++i) {
+    char sym_buf[16];
+    char day_buf[16];
+    char qty_buf[16];
+    char price_buf[16];
+    snprintf(sym_buf, sizeof(sym_buf), "s%zu", (i * 7) % 13);
+    snprintf(day_buf, sizeof(day_buf), "%zu", i % 3);
+    snprintf(qty_buf, sizeof(qty_buf), "%zu", i % 11);
+    snprintf(price_buf, sizeof(price_buf), "%zu.25", i % 5);
+    const char *row[] = {sym_buf, day_buf, qty_buf, price_buf};
+    if (i % 17 == 4) {
+      row[0] = "";
+    }
+    if (i % 9 == 2) {
+      row[3] = "";
+    }
+    CHECK(cp_df_append_row(full, row, 4, &err));
+    CHECK(cp_df_append_row(batches[i * 4 / 400], row, 4, &err));
+  }
+
+  const char *keys[] = {"sym", "day"};
+  const char *value_cols[] = {"qty", "price", "price", "price", "qty"};
+  CpAggOp ops[] = {CP_AGG_SUM, CP_AGG_COUNT, CP_AGG_MIN, CP_AGG_MAX,
+                   CP_AGG_MEAN};
+  const char *out_names[] = {"sym",       "day",       "qty_sum",
+                             "price_count", "price_min", "price_max",
+                             "qty_mean"};
+  CpDataFrame *expected =
+      cp_df_groupby_agg_multi(full, keys, 2, value_cols, ops, 5, &err);
+  CHECK(expected != NULL);
+
+  CpGroupbyState *stream =
+      cp_groupby_state_create(keys, 2, value_cols, ops, 5, &err);
+  CpGroupbyState *left =
+      cp_groupby_state_create(keys, 2, value_cols, ops, 5, &err);
+  CpGroupbyState *right =
+      cp_groupby_state_create(keys, 2, value_cols, ops, 5, &err);
+  CHECK(stream && left && right);
+  if (stream && left && right && expected) {
+    CHECK(cp_groupby_state_finalize(stream, &err) == NULL);
+    for (size_t b = 0; b < 4; ++b) {
+      CHECK(cp_groupby_state_update(stream, batches[b], &err));
+      CHECK(cp_groupby_state_update(b < 2 ? left : right, batches[b], &err));
+    }
+    CHECK(cp_groupby_state_ngroups(stream) == cp_df_nrows(expected));
+    CpDataFrame *streamed = cp_groupby_state_finalize(stream, &err);
+    CHECK(streamed != NULL);
+    if (streamed) {
+      CHECK(csv_frames_match(streamed, expected, out_names, 7));
+      cp_df_free(streamed);
+    }
+
+    CHECK(cp_groupby_state_merge(left, right, &err));
+    CpDataFrame *merged = cp_groupby_state_finalize(left, &err);
+    CHECK(merged != NULL);
+    if (merged) {
+      CHECK(csv_frames_match(merged, expected, out_names, 7));
+      cp_df_free(merged);
+    }
+
+    const char *bad_keys[] = {"sym"};
+    CpGroupbyState *other =
+        cp_groupby_state_create(bad_keys, 1, value_cols, ops, 5, &err);
+    CHECK(other != NULL);
+    CHECK(!cp_groupby_state_merge(left, other, &err));
+    cp_groupby_state_free(other);
+
+    const char *float_keys[] = {"price"};
+    CpGroupbyState *bad =
+        cp_groupby_state_create(float_keys, 1, value_cols, ops, 5, &err);
+    CHECK(bad != NULL);
+    CHECK(!cp_groupby_state_update(bad, full, &err));
+    cp_groupby_state_free(bad);
+  }
+
+  const char *big_names[] = {"k", "v"};
+  CpDType big_dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_INT64};
+  CpDataFrame *big = cp_df_create(2, big_names, big_dtypes, 0, &err);
+  const char *big_row[] = {"1", "9223372036854775000"};
+  CHECK(big && cp_df_append_row(big, big_row, 2, &err));
+  const char *big_keys[] = {"k"};
+  const char *big_cols[] = {"v"};
+  CpAggOp big_ops[] = {CP_AGG_SUM};
+  CpGroupbyState *first =
+      cp_groupby_state_create(big_keys, 1, big_cols, big_ops, 1, &err);
+  CpGroupbyState *second =
+      cp_groupby_state_create(big_keys, 1, big_cols, big_ops, 1, &err);
+  CHECK(first && second);
+  if (big && first && second) {
+    CHECK(cp_groupby_state_update(first, big, &err));
+    cp_error_clear(&err);
+    CHECK(!cp_groupby_state_update(first, big, &err));
+    CHECK(strcmp(err.message, "int64 sum overflow") == 0);
+    CHECK(cp_groupby_state_update(second, big, &err));
+    cp_error_clear(&err);
+    CHECK(!cp_groupby_state_merge(first, second, &err));
+    CHECK(strcmp(err.message, "int64 sum overflow") == 0);
+    CpDataFrame *kept = cp_groupby_state_finalize(first, &err);
+    CHECK(kept != NULL);
+    if (kept) {
+      int64_t total = 0;
+      int is_null = 0;
+      CHECK(cp_df_nrows(kept) == 1);
+      CHECK(cp_series_get_int64(cp_df_get_col(kept, "v_sum"), 0, &total,
+                                &is_null));
+      CHECK(total == INT64_C(9223372036854775000));
+      cp_df_free(kept);
+    }
+  }
+  cp_groupby_state_free(first);
+  cp_groupby_state_free(second);
+  cp_df_free(big);
+  cp_groupby_state_free(stream);
+  cp_groupby_state_free(left);
+  cp_groupby_state_free(right);
+  cp_df_free(expected);
+  cp_df_free(full);
+  for (size_t b = 0; b < 4; ++b) {
+    cp_df_free(batches[b]);
+  }
+}
+
 static void test_join_inner_left(void) {
   CpError err;
   cp_error_clear(&err);
@@ -5119,6 +7109,16 @@ static void test_join_strategy_forced(void) {
                                &err);
   assert_join_strategy_result(hash);
 
+  CpDataFrame *partitioned =
+      cp_df_join_with_strategy(left,
+                               right,
+                               "id",
+                               "id",
+                               CP_JOIN_INNER,
+                               CP_JOIN_STRATEGY_PARTITIONED_HASH,
+                               &err);
+  assert_join_strategy_result(partitioned);
+
   CpDataFrame *auto_join =
       cp_df_join_with_strategy(left,
                                right,
@@ -5138,6 +7138,7 @@ static void test_join_strategy_forced(void) {
   if (hash) {
     cp_df_free(hash);
   }
+  cp_df_free(partitioned);
   if (auto_join) {
     cp_df_free(auto_join);
   }
@@ -5145,6 +7146,161 @@ static void test_join_strategy_forced(void) {
   cp_df_free(left);
 }
 
+static void test_join_partitioned(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *left_names[] = {"id", "key", "lval"};
+  const char *right_names[] = {"id", "key", "rval"};
+  CpDType types[] = {CP_DTYPE_INT64, CP_DTYPE_STRING, CP_DTYPE_FLOAT64};
+  CpDataFrame *left = cp_df_create(3, left_names, types, 0, &err);
+  CpDataFrame *right = cp_df_create(3, right_names, types, 0, &err);
+  CHECK(left && right);
+  if (!left || !right) {
+    cp_df_free(left);
+    cp_df_free(right);
+    return;
+  }
+  for (size_t i = 0; i < 30000; ++i) {
+    char id[32];
+    char key[32];
+    char val[32];
+    snprintf(id, sizeof(id), "%zu", (i * 7919) % 12000);
+    snprintf(key, sizeof(key), "k%zu", i % 3);
+    snprintf(val, sizeof(val), "%zu.5", i);
+    const char *row[3] = {i % 101 == 0 ? "" : id, key, val};
+    CHECK(cp_df_append_row(left, row, 3, &err));
+  }
+  for (size_t i = 0; i < 20000; ++i) {
+    char id[32];
+    char key[32];
+    char val[32];
+    snprintf(id, sizeof(id), "%zu", 6000 + (i % 14000));
+    snprintf(key, sizeof(key), "k%zu", i % 4);
+    snprintf(val, sizeof(val), "%zu", i);
+    const char *row[3] = {id, i % 97 == 0 ? "" : key, i % 5 == 0 ? "" : val};
+    CHECK(cp_df_append_row(right, row, 3, &err));
+  }
+
+  const char *keys[] = {"id", "key"};
+  const char *out_names[] = {"id", "key", "lval", "rval"};
+  CpJoinType hows[] = {CP_JOIN_INNER, CP_JOIN_LEFT, CP_JOIN_RIGHT,
+                       CP_JOIN_OUTER};
+  for (size_t h = 0; h < 4; ++h) {
+    CpDataFrame *expected = cp_df_join_multi_with_strategy(
+        left, right, keys, keys, 2, hows[h], NULL, NULL,
+        CP_JOIN_STRATEGY_HASH, &err);
+    CpDataFrame *partitioned = cp_df_join_multi_with_strategy(
+        left, right, keys, keys, 2, hows[h], NULL, NULL,
+        CP_JOIN_STRATEGY_PARTITIONED_HASH, &err);
+    CHECK(expected && partitioned && cp_df_nrows(expected) > 0);
+    CHECK(expected && partitioned &&
+          csv_frames_match(partitioned, expected, out_names, 4));
+    cp_df_free(partitioned);
+    cp_df_free(expected);
+  }
+
+  CpDataFrame *expected = cp_df_join_with_strategy(
+      left, right, "id", "id", CP_JOIN_OUTER, CP_JOIN_STRATEGY_HASH, &err);
+  CpDataFrame *partitioned = cp_df_join_with_strategy(
+      left, right, "id", "id", CP_JOIN_OUTER,
+      CP_JOIN_STRATEGY_PARTITIONED_HASH, &err);
+  const char *single_names[] = {"id", "key", "lval", "key_right", "rval"};
+  CHECK(expected && partitioned &&
+        csv_frames_match(partitioned, expected, single_names, 5));
+  cp_df_free(partitioned);
+  cp_df_free(expected);
+  cp_df_free(right);
+  cp_df_free(left);
+}
+
+static void check_asof_bids(const CpDataFrame *df,
+                            const char *col,
+                            const int64_t *expected,
+                            size_t count) {
+  const CpSeries *bid = df ? cp_df_get_col(df, col) : NULL;
+  CHECK(bid != NULL && cp_df_nrows(df) == count);
+  for (size_t i = 0; bid && i < count; ++i) {
+    int64_t v = 0;
+    int is_null = 0;
+    CHECK(cp_series_get_int64(bid, i, &v, &is_null));
+    CHECK(expected[i] < 0 ? is_null : (!is_null && v == expected[i]));
+  }
+}
+
+static void test_join_asof(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *left_names[] = {"time", "sym", "qty"};
+  const char *right_names[] = {"time", "sym", "bid"};
+  CpDType types[] = {CP_DTYPE_INT64, CP_DTYPE_STRING, CP_DTYPE_INT64};
+  CpDataFrame *trades = cp_df_create(3, left_names, types, 0, &err);
+  CpDataFrame *quotes = cp_df_create(3, right_names, types, 0, &err);
+  CHECK(trades && quotes);
+  if (!trades || !quotes) {
+    cp_df_free(trades);
+    cp_df_free(quotes);
+    return;
+  }
+  const char *q[][3] = {{"1", "A", "10"}, {"2", "B", "20"}, {"5", "A", "11"},
+                        {"5", "A", "12"}, {"9", "B", "21"}};
+  for (size_t i = 0; i < 5; ++i) {
+    CHECK(cp_df_append_row(quotes, q[i], 3, &err));
+  }
+  const char *t[][3] = {{"6", "A", "100"}, {"3", "B", "200"},
+                        {"0", "A", "300"}, {"5", "A", "400"},
+                        {"", "B", "500"},  {"8", "C", "600"},
+                        {"8", "B", "700"}};
+  for (size_t i = 0; i < 7; ++i) {
+    CHECK(cp_df_append_row(trades, t[i], 3, &err));
+  }
+
+  CpDataFrame *back =
+      cp_df_join_asof(trades, quotes, "time", "sym", CP_ASOF_BACKWARD, -1, &err);
+  int64_t back_bids[] = {12, 20, -1, 12, -1, -1, 20};
+  check_asof_bids(back, "bid", back_bids, 7);
+  CHECK(back && cp_df_ncols(back) == 4);
+  const CpSeries *qty = back ? cp_df_get_col(back, "qty") : NULL;
+  int64_t v = 0;
+  int is_null = 0;
+  CHECK(qty && cp_series_get_int64(qty, 6, &v, &is_null) && v == 700);
+
+  CpDataFrame *fwd =
+      cp_df_join_asof(trades, quotes, "time", "sym", CP_ASOF_FORWARD, -1, &err);
+  int64_t fwd_bids[] = {-1, 21, 10, 11, -1, -1, 21};
+  check_asof_bids(fwd, "bid", fwd_bids, 7);
+
+  CpDataFrame *nearest =
+      cp_df_join_asof(trades, quotes, "time", "sym", CP_ASOF_NEAREST, -1, &err);
+  int64_t nearest_bids[] = {12, 20, 10, 12, -1, -1, 21};
+  check_asof_bids(nearest, "bid", nearest_bids, 7);
+
+  CpDataFrame *tol =
+      cp_df_join_asof(trades, quotes, "time", "sym", CP_ASOF_BACKWARD, 2, &err);
+  int64_t tol_bids[] = {12, 20, -1, 12, -1, -1, -1};
+  check_asof_bids(tol, "bid", tol_bids, 7);
+
+  CpDataFrame *no_by =
+      cp_df_join_asof(trades, quotes, "time", NULL, CP_ASOF_BACKWARD, -1, &err);
+  int64_t no_by_bids[] = {12, 20, -1, 12, -1, 12, 12};
+  check_asof_bids(no_by, "bid", no_by_bids, 7);
+  CHECK(no_by && cp_df_get_col(no_by, "sym_right") != NULL);
+
+  cp_error_clear(&err);
+  CHECK(cp_df_join_asof(trades, quotes, "sym", NULL, CP_ASOF_BACKWARD, -1,
+                        &err) == NULL);
+  CHECK(err.code == CP_ERR_INVALID);
+
+  cp_df_free(no_by);
+  cp_df_free(tol);
+  cp_df_free(nearest);
+  cp_df_free(fwd);
+  cp_df_free(back);
+  cp_df_free(quotes);
+  cp_df_free(trades);
+}
+
 static void test_pivot_table(void) {
   CpError err;
   cp_error_clear(&err);
@@ -5481,32 +7637,236 @@ static void test_resample(void) {
     int64_t ts_val = 0;
     int64_t i64_val = 0;
 
-    CHECK(cp_series_get_int64(ts, 0, &ts_val, &is_null));
-    CHECK(!is_null && ts_val == 0);
-    CHECK(cp_series_get_int64(value_sum, 0, &i64_val, &is_null));
-    CHECK(!is_null && i64_val == 15);
-    CHECK(cp_series_get_int64(label_count, 0, &i64_val, &is_null));
-    CHECK(!is_null && i64_val == 1);
+    CHECK(cp_series_get_int64(ts, 0, &ts_val, &is_null));
+    CHECK(!is_null && ts_val == 0);
+    CHECK(cp_series_get_int64(value_sum, 0, &i64_val, &is_null));
+    CHECK(!is_null && i64_val == 15);
+    CHECK(cp_series_get_int64(label_count, 0, &i64_val, &is_null));
+    CHECK(!is_null && i64_val == 1);
+
+    CHECK(cp_series_get_int64(ts, 1, &ts_val, &is_null));
+    CHECK(!is_null && ts_val == 60);
+    CHECK(cp_series_get_int64(value_sum, 1, &i64_val, &is_null));
+    CHECK(!is_null && i64_val == 3);
+    CHECK(cp_series_get_int64(label_count, 1, &i64_val, &is_null));
+    CHECK(!is_null && i64_val == 1);
+
+    CHECK(cp_series_get_int64(ts, 2, &ts_val, &is_null));
+    CHECK(!is_null && ts_val == 120);
+    CHECK(cp_series_get_int64(value_sum, 2, &i64_val, &is_null));
+    CHECK(!is_null && i64_val == 8);
+    CHECK(cp_series_get_int64(label_count, 2, &i64_val, &is_null));
+    CHECK(!is_null && i64_val == 1);
+  }
+
+  if (resampled) {
+    cp_df_free(resampled);
+  }
+  cp_df_free(df);
+}
+
+static int rolling_matches(const CpSeries *values,
+                           const size_t *starts,
+                           size_t min_periods,
+                           const CpDataFrame *out) {
+  static const char *float_cols[] = {"value_sum", "value_mean", "value_min",
+                                     "value_max", "value_std"};
+  const CpSeries *counts = cp_df_get_col(out, "value_count");
+  if (!counts) {
+    return 0;
+  }
+  size_t nrows = cp_df_nrows(out);
+  for (size_t row = 0; row < nrows; ++row) {
+    size_t valid = 0;
+    double sum = 0.0;
+    double lo = 0.0;
+    double hi = 0.0;
+    for (size_t i = starts[row]; i <= row; ++i) {
+      double v = 0.0;
+      int is_null = 0;
+      if (!cp_series_get_float64(values, i, &v, &is_null) || is_null) {
+        continue;
+      }
+      lo = valid == 0 || v < lo ? v : lo;
+      hi = valid == 0 || v > hi ? v : hi;
+      sum += v;
+      valid += 1;
+    }
+    double ss = 0.0;
+    for (size_t i = starts[row]; valid > 0 && i <= row; ++i) {
+      double v = 0.0;
+      int is_null = 0;
+      if (cp_series_get_float64(values, i, &v, &is_null) && !is_null) {
+        ss += (v - sum / (double)valid) * (v - sum / (double)valid);
+      }
+    }
+    int empty = valid == 0 || valid < min_periods;
+    int64_t count_val = 0;
+    int is_null = 0;
+    if (!cp_series_get_int64(counts, row, &count_val, &is_null) ||
+        is_null != (valid < min_periods) ||
+        (!is_null && count_val != (int64_t)valid)) {
+      return 0;
+    }
+    double expected[5] = {sum, sum / (double)valid, lo, hi,
+                          valid > 1 ? sqrt(ss / (double)(valid - 1)) : 0.0};
+    for (size_t k = 0; k < 5; ++k) {
+      double got = 0.0;
+      int want_null = empty || (k == 4 && valid < 2);
+      if (!cp_series_get_float64(cp_df_get_col(out, float_cols[k]), row,
+                                 &got, &is_null) ||
+          is_null != want_null ||
+          (!is_null &&
+           fabs(got - expected[k]) > 1e-9 * (1.0 + fabs(expected[k])))) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+static void test_rolling_windows(void) {
+  CpError err;
+  cp_error_clear(&err);
 
-    CHECK(cp_series_get_int64(ts, 1, &ts_val, &is_null));
-    CHECK(!is_null && ts_val == 60);
-    CHECK(cp_series_get_int64(value_sum, 1, &i64_val, &is_null));
-    CHECK(!is_null && i64_val == 3);
-    CHECK(cp_series_get_int64(label_count, 1, &i64_val, &is_null));
-    CHECK(!is_null && i64_val == 1);
+  const char *names[] = {"ts", "value"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64};
+  CpDataFrame *df = cp_df_create(2, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  const size_t nrows = 300;
+  int64_t times[300];
+  int64_t ts = 0;
+  for (size_t row = 0; row < nrows; ++row) {
+    char ts_buf[32];
+    char value_buf[32];
+    ts += (int64_t)((row * 7) % 5);
+    times[row] = ts;
+    snprintf(ts_buf, sizeof(ts_buf), "%lld", (long long)ts);
+    snprintf(value_buf, sizeof(value_buf), "%.3f",
+             (double)((row * 37) % 101) - 50.0 + 1e6 * (double)(row % 3));
+    const char *fields[] = {ts_buf, value_buf};
+    if (row % 7 == 3) {
+      fields[1] = "";
+    }
+    CHECK(cp_df_append_row(df, fields, 2, &err));
+  }
+  const CpSeries *values = cp_df_get_col(df, "value");
+
+  const char *cols[] = {"value", "value", "value", "value", "value", "value"};
+  CpRollingOp ops[] = {CP_ROLLING_COUNT, CP_ROLLING_SUM, CP_ROLLING_MEAN,
+                       CP_ROLLING_MIN,   CP_ROLLING_MAX, CP_ROLLING_STD};
+  size_t starts[300];
+  const size_t windows[] = {1, 3, 17};
+  for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); ++w) {
+    size_t min_periods = windows[w] > 2 ? 2 : 1;
+    for (size_t row = 0; row < nrows; ++row) {
+      starts[row] = row + 1 > windows[w] ? row + 1 - windows[w] : 0;
+    }
+    CpDataFrame *rolled = cp_df_rolling(df, NULL, windows[w], 0, min_periods,
+                                        cols, ops, 6, &err);
+    CHECK(rolled != NULL);
+    if (rolled) {
+      CHECK(cp_df_ncols(rolled) == 6);
+      CHECK(cp_df_get_col(rolled, "value_std") != NULL);
+      CHECK(rolling_matches(values, starts, min_periods, rolled));
+      cp_df_free(rolled);
+    }
+  }
 
-    CHECK(cp_series_get_int64(ts, 2, &ts_val, &is_null));
-    CHECK(!is_null && ts_val == 120);
-    CHECK(cp_series_get_int64(value_sum, 2, &i64_val, &is_null));
-    CHECK(!is_null && i64_val == 8);
-    CHECK(cp_series_get_int64(label_count, 2, &i64_val, &is_null));
-    CHECK(!is_null && i64_val == 1);
+  for (size_t row = 0; row < nrows; ++row) {
+    size_t start = 0;
+    while (times[row] - times[start] >= 10) {
+      start += 1;
+    }
+    starts[row] = start;
+  }
+  CpDataFrame *timed =
+      cp_df_rolling(df, "ts", 0, 10, 0, cols, ops, 6, &err);
+  CHECK(timed != NULL);
+  if (timed) {
+    CHECK(cp_df_ncols(timed) == 7);
+    CHECK(cp_df_get_col(timed, "ts") != NULL);
+    CHECK(rolling_matches(values, starts, 1, timed));
+    cp_df_free(timed);
+  }
+
+  memset(starts, 0, sizeof(starts));
+  CpDataFrame *expanding = cp_df_expanding(df, 5, cols, ops, 6, &err);
+  CHECK(expanding != NULL);
+  if (expanding) {
+    CHECK(rolling_matches(values, starts, 5, expanding));
+    cp_df_free(expanding);
+  }
+
+  CpDataFrame *defaulted =
+      cp_df_rolling(df, NULL, 4, 0, 0, cols + 1, ops + 1, 1, &err);
+  CHECK(defaulted != NULL);
+  if (defaulted) {
+    int is_null = 0;
+    double sum = 0.0;
+    CHECK(cp_series_get_float64(cp_df_get_col(defaulted, "value_sum"), 2,
+                                &sum, &is_null));
+    CHECK(is_null);
+    cp_df_free(defaulted);
   }
 
-  if (resampled) {
-    cp_df_free(resampled);
+  CHECK(cp_df_rolling(df, NULL, 3, 0, 4, cols, ops, 1, &err) == NULL);
+  CHECK(cp_df_rolling(df, "value", 0, 10, 0, cols, ops, 1, &err) == NULL);
+  CpDataFrame *shuffled = cp_df_sort_values(df, "value", 1, &err);
+  CHECK(shuffled != NULL);
+  if (shuffled) {
+    CHECK(cp_df_rolling(shuffled, "ts", 0, 10, 0, cols, ops, 1, &err) ==
+          NULL);
+    cp_df_free(shuffled);
   }
   cp_df_free(df);
+
+  /* A large outlier leaving the window must not leave drift behind. */
+  CpDataFrame *spiky = cp_df_create(2, names, dtypes, 0, &err);
+  CHECK(spiky != NULL);
+  if (!spiky) {
+    return;
+  }
+  double spiky_values[60];
+  for (size_t row = 0; row < 60; ++row) {
+    char ts_buf[32];
+    char value_buf[40];
+    spiky_values[row] = row == 5    ? 1e12
+                        : row < 30 ? 1.1
+                                   : 1.1 + (double)(row % 3) * 1e-3;
+    snprintf(ts_buf, sizeof(ts_buf), "%zu", row);
+    snprintf(value_buf, sizeof(value_buf), "%.17g", spiky_values[row]);
+    const char *fields[] = {ts_buf, value_buf};
+    CHECK(cp_df_append_row(spiky, fields, 2, &err));
+  }
+  CpDataFrame *spiky_std =
+      cp_df_rolling(spiky, "ts", 0, 6, 0, cols + 5, ops + 5, 1, &err);
+  CHECK(spiky_std != NULL);
+  if (spiky_std) {
+    const CpSeries *std_col = cp_df_get_col(spiky_std, "value_std");
+    int ok = std_col != NULL;
+    for (size_t row = 11; ok && row < 60; ++row) {
+      double mean = 0.0;
+      double m2 = 0.0;
+      for (size_t i = row - 5; i <= row; ++i) {
+        mean += spiky_values[i] / 6.0;
+      }
+      for (size_t i = row - 5; i <= row; ++i) {
+        m2 += (spiky_values[i] - mean) * (spiky_values[i] - mean);
+      }
+      double want = row < 30 ? 0.0 : sqrt(m2 / 5.0);
+      double got = -1.0;
+      int is_null = 1;
+      cp_series_get_float64(std_col, row, &got, &is_null);
+      ok = !is_null && (row < 30 ? got == 0.0 : fabs(got - want) < 1e-9);
+    }
+    CHECK(ok);
+    cp_df_free(spiky_std);
+  }
+  cp_df_free(spiky);
 }
 
 static void test_predicate_filters(void) {
@@ -5913,6 +8273,736 @@ static void test_query(void) {
   cp_df_free(df);
 }
 
+static void test_simd_dispatch(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+#ifdef _WIN32
+  (void)err;
+  return;
+#else
+  const char *names[] = {"a", "b", "x", "y"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_INT64, CP_DTYPE_FLOAT64,
+                      CP_DTYPE_FLOAT64};
+  CpDataFrame *df = cp_df_create(4, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  for (int i = 0; i < 1003; ++i) {
+    char a[32];
+    char b[32];
+    char x[32];
+    char y[32];
+    snprintf(a, sizeof(a), "%d", (i * 7919) % 1000 - 500);
+    snprintf(b, sizeof(b), "%d", (i * 104729) % 1000 - 500);
+    snprintf(x, sizeof(x), "%d.5", (i * 31) % 200 - 100);
+    snprintf(y, sizeof(y), "%d.5", (i * 17) % 200 - 100);
+    const char *row[4] = {i % 101 == 7 ? "" : a, b,
+                          i % 29 == 3 ? "nan" : x, i % 37 == 1 ? "" : y};
+    CHECK(cp_df_append_row(df, row, 4, &err));
+  }
+  const char *overflow_names[] = {"v"};
+  CpDType overflow_dtypes[] = {CP_DTYPE_INT64};
+  CpDataFrame *big = cp_df_create(1, overflow_names, overflow_dtypes, 0, &err);
+  CHECK(big != NULL);
+  const char *big_rows[][1] = {{"9223372036854775807"}, {"1"}, {"0"}};
+  for (size_t i = 0; big && i < 3; ++i) {
+    CHECK(cp_df_append_row(big, big_rows[i], 1, &err));
+  }
+
+  const char *levels[] = {"scalar", "sse2", "neon", "avx2", "avx512"};
+  int64_t want_sum = 0;
+  int64_t want_min = 0;
+  int64_t want_max = 0;
+  uint8_t want_masks[4][6][1003];
+  for (size_t level = 0; level < 5; ++level) {
+    CHECK(cp_set_simd_isa(levels[level], &err));
+    const CpSeries *b = cp_df_get_col(df, "b");
+    int64_t sum = 0;
+    int64_t min_val = 0;
+    int64_t max_val = 0;
+    size_t count = 0;
+    size_t nulls = 0;
+    CHECK(cp_series_sum_int64(b, &sum, &count, &nulls, &err));
+    CHECK(cp_series_min_int64(b, &min_val, &nulls, &err));
+    CHECK(cp_series_max_int64(b, &max_val, &nulls, &err));
+    if (level == 0) {
+      want_sum = sum;
+      want_min = min_val;
+      want_max = max_val;
+    }
+    CHECK(sum == want_sum && min_val == want_min && max_val == want_max);
+    if (big) {
+      cp_error_clear(&err);
+      CHECK(!cp_series_sum_int64(cp_df_get_col(big, "v"), &sum, &count,
+                                 &nulls, &err));
+      CHECK(err.code == CP_ERR_INVALID);
+    }
+    for (int op = CP_OP_EQ; op <= CP_OP_GE; ++op) {
+      uint8_t masks[4][1003];
+      CHECK(cp_df_mask_int64(df, "a", (CpCompareOp)op, 17, masks[0], 1003,
+                             &err));
+      CHECK(cp_df_mask_float64(df, "x", (CpCompareOp)op, 20.5, masks[1], 1003,
+                               &err));
+      CHECK(cp_df_mask_cols(df, "a", (CpCompareOp)op, "b", masks[2], 1003,
+                            &err));
+      CHECK(cp_df_mask_cols(df, "x", (CpCompareOp)op, "y", masks[3], 1003,
+                            &err));
+      for (size_t k = 0; k < 4; ++k) {
+        if (level == 0) {
+          memcpy(want_masks[k][op], masks[k], 1003);
+        }
+        CHECK(memcmp(want_masks[k][op], masks[k], 1003) == 0);
+      }
+    }
+  }
+  CHECK(cp_set_simd_isa("scalar", &err));
+  CHECK(strcmp(cp_simd_isa(), "scalar") == 0);
+  CHECK(!cp_set_simd_isa("mmx", &err));
+  CHECK(strcmp(cp_simd_isa(), "scalar") == 0);
+  CHECK(cp_set_simd_isa(NULL, &err));
+  CHECK(cp_simd_isa() != NULL);
+
+  uint8_t mask[1003];
+  CHECK(cp_df_mask_float64(df, "x", CP_OP_NE, 20.5, mask, 1003, &err));
+  CHECK(mask[3] == 0);
+  CHECK(cp_df_mask_int64(df, "a", CP_OP_GE, -1000, mask, 1003, &err));
+  CHECK(mask[7] == 0 && mask[8] == 1);
+
+  cp_df_free(big);
+  cp_df_free(df);
+#endif
+}
+
+typedef struct {
+  size_t allocs;
+  long live;
+} CountingAllocator;
+
+static void *counting_malloc(size_t size, void *user_data) {
+  CountingAllocator *counter = (CountingAllocator *)user_data;
+  void *out = malloc(size);
+  if (out) {
+    counter->allocs += 1;
+    counter->live += 1;
+  }
+  return out;
+}
+
+static void *counting_realloc(void *ptr, size_t size, void *user_data) {
+  CountingAllocator *counter = (CountingAllocator *)user_data;
+  void *out = realloc(ptr, size);
+  if (out && !ptr) {
+    counter->allocs += 1;
+    counter->live += 1;
+  }
+  return out;
+}
+
+static void counting_free(void *ptr, void *user_data) {
+  CountingAllocator *counter = (CountingAllocator *)user_data;
+  counter->live -= 1;
+  free(ptr);
+}
+
+static CpDataFrame *allocator_workload(CpError *err) {
+  const char *names[] = {"sym", "qty"};
+  CpDType dtypes[] = {CP_DTYPE_STRING, CP_DTYPE_INT64};
+  CpDataFrame *df = cp_df_create(2, names, dtypes, 0, err);
+  if (!df) {
+    return NULL;
+  }
+  for (size_t i = 0; i < 300; ++i) {
+    char sym_buf[16];
+    char qty_buf[16];
+    snprintf(sym_buf, sizeof(sym_buf), "s%zu", i % 7);
+    snprintf(qty_buf, sizeof(qty_buf), "%zu", i);
+    const char *row[] = {sym_buf, qty_buf};
+    if (!cp_df_append_row(df, row, 2, err)) {
+      cp_df_free(df);
+      return NULL;
+    }
+  }
+  const char *value_cols[] = {"qty"};
+  CpAggOp ops[] = {CP_AGG_SUM};
+  CpDataFrame *grouped = cp_df_groupby_agg(df, "sym", value_cols, ops, 1, err);
+  CpDataFrame *sorted =
+      grouped ? cp_df_sort_values(grouped, "qty_sum", 0, err) : NULL;
+  cp_df_free(grouped);
+  cp_df_free(df);
+  return sorted;
+}
+
+static void test_allocator_hooks(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  CpAllocator bad = {counting_malloc, NULL, counting_free, NULL};
+  CHECK(!cp_set_allocator(&bad, &err));
+  CHECK(err.code == CP_ERR_INVALID);
+
+  CountingAllocator counter = {0, 0};
+  CpAllocator hooks = {counting_malloc, counting_realloc, counting_free,
+                       &counter};
+  CHECK(cp_set_allocator(&hooks, &err));
+  CpAllocator current;
+  cp_get_allocator(&current);
+  CHECK(current.user_data == &counter);
+  CpDataFrame *sorted = allocator_workload(&err);
+  CHECK(sorted != NULL);
+  char *text = sorted ? cp_df_to_string(sorted, &err) : NULL;
+  CHECK(text != NULL);
+  cp_free(text);
+  cp_df_free(sorted);
+  CHECK(cp_set_allocator(NULL, &err));
+  CHECK(counter.allocs > 0);
+  CHECK(counter.live == 0);
+
+  CpArena *arena = cp_arena_create(4096, &err);
+  CHECK(arena != NULL);
+  if (!arena) {
+    return;
+  }
+  CpAllocator arena_hooks = cp_arena_allocator(arena);
+  for (int pass = 0; pass < 2; ++pass) {
+    CHECK(cp_set_allocator(&arena_hooks, &err));
+    CpDataFrame *result = allocator_workload(&err);
+    CHECK(result != NULL && cp_df_nrows(result) == 7);
+    const CpSeries *qty = result ? cp_df_get_col(result, "qty_sum") : NULL;
+    CHECK(qty != NULL);
+    int64_t top = 0;
+    if (qty) {
+      CHECK(cp_series_get_int64(qty, 0, &top, NULL));
+    }
+    CHECK(top == 6536);
+    CHECK(cp_set_allocator(NULL, &err));
+    CHECK(cp_arena_bytes(arena) >= 4096);
+    cp_arena_reset(arena);
+  }
+  cp_arena_free(arena);
+}
+
+typedef struct {
+  size_t live;
+} ByteCounter;
+
+/* Keeps each block's size in a 16-byte header so frees can be tallied. */
+static void *byte_counting_malloc(size_t size, void *user_data) {
+  ByteCounter *counter = (ByteCounter *)user_data;
+  unsigned char *raw = (unsigned char *)malloc(size + 16);
+  if (!raw) {
+    return NULL;
+  }
+  memcpy(raw, &size, sizeof(size));
+  counter->live += size;
+  return raw + 16;
+}
+
+static void byte_counting_free(void *ptr, void *user_data) {
+  if (!ptr) {
+    return;
+  }
+  ByteCounter *counter = (ByteCounter *)user_data;
+  unsigned char *raw = (unsigned char *)ptr - 16;
+  size_t size = 0;
+  memcpy(&size, raw, sizeof(size));
+  counter->live -= size;
+  free(raw);
+}
+
+static void *byte_counting_realloc(void *ptr, size_t size, void *user_data) {
+  void *out = byte_counting_malloc(size, user_data);
+  if (out && ptr) {
+    size_t old = 0;
+    memcpy(&old, (unsigned char *)ptr - 16, sizeof(old));
+    memcpy(out, ptr, old < size ? old : size);
+    byte_counting_free(ptr, user_data);
+  }
+  return out;
+}
+
+static void test_memory_usage_shared_arena(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  ByteCounter counter = {0};
+  CpAllocator hooks = {byte_counting_malloc, byte_counting_realloc,
+                       byte_counting_free, &counter};
+  CHECK(cp_set_allocator(&hooks, &err));
+  const char *names[] = {"id", "name"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_STRING};
+  const size_t rows = 100000;
+  CpDataFrame *df = cp_df_create(2, names, dtypes, rows, &err);
+  uint8_t *mask = (uint8_t *)calloc(rows, 1);
+  CHECK(df != NULL && mask != NULL);
+  for (size_t i = 0; df && i < rows; ++i) {
+    char id_buf[32];
+    char name_buf[48];
+    snprintf(id_buf, sizeof(id_buf), "%zu", i);
+    snprintf(name_buf, sizeof(name_buf), "customer-name-%zu", i);
+    const char *row[] = {id_buf, name_buf};
+    if (!cp_df_append_row(df, row, 2, &err)) {
+      CHECK(0);
+      break;
+    }
+  }
+  CpDataFrame *one = NULL;
+  if (df && mask) {
+    mask[rows / 2] = 1;
+    one = cp_df_filter_mask(df, mask, rows, &err);
+  }
+  CHECK(one != NULL && cp_df_nrows(one) == 1);
+  cp_df_free(df);
+  size_t live = counter.live;
+  size_t total = 0;
+  if (one) {
+    CHECK(cp_df_memory_usage(one, 1, NULL, 0, &total, &err));
+  }
+  CHECK(live > rows * 16);
+  CHECK(total <= live + live / 10 && total >= live - live / 10);
+  cp_df_free(one);
+  CHECK(cp_set_allocator(NULL, &err));
+  CHECK(counter.live == 0);
+  free(mask);
+}
+
+static void test_memory_usage(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "name", "code"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_STRING, CP_DTYPE_CATEGORY};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, 4, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  const char *rows[][3] = {
+      {"1", "alpha", "x"}, {"2", "", "y"}, {"3", "gamma", "x"}};
+  for (size_t i = 0; i < 3; ++i) {
+    CHECK(cp_df_append_row(df, rows[i], 3, &err));
+  }
+
+  size_t shallow[3];
+  size_t deep[3];
+  size_t shallow_total = 0;
+  size_t deep_total = 0;
+  CHECK(cp_df_memory_usage(df, 0, shallow, 3, &shallow_total, &err));
+  CHECK(cp_df_memory_usage(df, 1, deep, 3, &deep_total, &err));
+  CHECK(shallow[0] == deep[0]);
+  CHECK(shallow[0] >= 4 * sizeof(int64_t));
+  CHECK(deep[1] - shallow[1] >= strlen("alpha") + strlen("gamma") + 2);
+  CHECK(deep[2] > shallow[2] + 4);
+  CHECK(shallow_total >= shallow[0] + shallow[1] + shallow[2]);
+  CHECK(deep_total - shallow_total ==
+        (deep[1] - shallow[1]) + (deep[2] - shallow[2]));
+
+  size_t small[2];
+  CHECK(!cp_df_memory_usage(df, 0, small, 2, NULL, &err));
+  CHECK(err.code == CP_ERR_INVALID);
+  cp_df_free(df);
+}
+
+typedef struct {
+  size_t count;
+  char ops[8][32];
+  char strategies[8][32];
+  size_t rows_out[8];
+  int has_phase[8];
+  int ok[8];
+} TraceLog;
+
+static void record_trace(const CpTraceEvent *event, void *user_data) {
+  TraceLog *log = (TraceLog *)user_data;
+  if (log->count >= 8) {
+    return;
+  }
+  size_t i = log->count++;
+  snprintf(log->ops[i], sizeof(log->ops[i]), "%s", event->op);
+  snprintf(log->strategies[i], sizeof(log->strategies[i]), "%s",
+           event->strategy ? event->strategy : "");
+  log->rows_out[i] = event->rows_out;
+  log->ok[i] = event->ok;
+  const char *want = strcmp(event->op, "join") == 0 ? "probe" : "decode";
+  if (strcmp(event->op, "groupby_agg") == 0) {
+    want = "aggregate";
+  }
+  for (size_t p = 0; p < event->phase_count; ++p) {
+    if (strcmp(event->phases[p].name, want) == 0 &&
+        event->phases[p].wall_seconds >= 0.0 &&
+        event->phases[p].wall_seconds <= event->wall_seconds + 1e-6) {
+      log->has_phase[i] = 1;
+    }
+  }
+}
+
+static void test_trace_callback(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  TraceLog log;
+  memset(&log, 0, sizeof(log));
+  if (!cp_set_trace_callback(record_trace, &log, &err)) {
+    CHECK(err.code == CP_ERR_INVALID);
+    return;
+  }
+
+  const char *names[] = {"id", "val"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_INT64};
+  CpDataFrame *left = cp_df_create(2, names, dtypes, 0, &err);
+  CpDataFrame *right = cp_df_create(2, names, dtypes, 0, &err);
+  CHECK(left != NULL && right != NULL);
+  for (size_t i = 0; left && right && i < 200; ++i) {
+    char id_buf[16];
+    char val_buf[16];
+    snprintf(id_buf, sizeof(id_buf), "%zu", i % 50);
+    snprintf(val_buf, sizeof(val_buf), "%zu", i);
+    const char *row[] = {id_buf, val_buf};
+    CHECK(cp_df_append_row(left, row, 2, &err));
+    if (i < 100) {
+      CHECK(cp_df_append_row(right, row, 2, &err));
+    }
+  }
+
+  const char *keys[] = {"id"};
+  CpDataFrame *joined = cp_df_join_multi_with_strategy(
+      left, right, keys, keys, 1, CP_JOIN_INNER, "", "_r",
+      CP_JOIN_STRATEGY_AUTO, &err);
+  CHECK(joined != NULL && cp_df_nrows(joined) == 400);
+  const char *value_cols[] = {"val"};
+  CpAggOp ops[] = {CP_AGG_SUM};
+  CpDataFrame *grouped = cp_df_groupby_agg(left, "id", value_cols, ops, 1,
+                                           &err);
+  CHECK(grouped != NULL);
+  char *path = make_temp_path();
+  CHECK(path != NULL);
+  CpDataFrame *loaded = NULL;
+  if (path) {
+    CHECK(cp_df_write_parquet(left, path, &err));
+    loaded = cp_df_read_parquet(path, &err);
+    CHECK(loaded != NULL);
+  }
+  CHECK(cp_df_read_parquet("/nonexistent/cpandas.parquet", &err) == NULL);
+
+  CHECK(cp_set_trace_callback(NULL, NULL, &err));
+  cp_df_free(cp_df_groupby_agg(left, "id", value_cols, ops, 1, &err));
+
+  CHECK(log.count == 4);
+  CHECK(strcmp(log.ops[0], "join") == 0);
+  CHECK(strcmp(log.strategies[0], "sorted") == 0);
+  CHECK(log.rows_out[0] == 400 && log.ok[0] && log.has_phase[0]);
+  CHECK(strcmp(log.ops[1], "groupby_agg") == 0);
+  CHECK(strcmp(log.strategies[1], "hash") == 0);
+  CHECK(log.rows_out[1] == 50 && log.has_phase[1]);
+  CHECK(strcmp(log.ops[2], "read_parquet") == 0);
+  CHECK(log.rows_out[2] == 200 && log.ok[2] && log.has_phase[2]);
+  CHECK(strcmp(log.ops[3], "read_parquet") == 0);
+  CHECK(!log.ok[3] && log.rows_out[3] == 0);
+
+  if (path) {
+    remove(path);
+    free(path);
+  }
+  cp_df_free(loaded);
+  cp_df_free(grouped);
+  cp_df_free(joined);
+  cp_df_free(left);
+  cp_df_free(right);
+}
+
+static void test_query_batches(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "score", "tag"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_FLOAT64, CP_DTYPE_CATEGORY};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  const char *tags[] = {"a", "b", "c"};
+  size_t expect = 0;
+  size_t expect_nulls = 0;
+  for (int i = 0; i < 10000; ++i) {
+    char id[32];
+    char score[32];
+    snprintf(id, sizeof(id), "%d", i);
+    snprintf(score, sizeof(score), "%d.25", i);
+    int id_null = i % 97 == 0;
+    int score_null = i % 13 == 0;
+    int score_nan = !score_null && i % 5 == 0;
+    int tag_null = i % 17 == 0;
+    const char *row[3] = {id_null ? "" : id,
+                          score_null ? "" : (score_nan ? "nan" : score),
+                          tag_null ? "" : tags[i % 3]};
+    CHECK(cp_df_append_row(df, row, 3, &err));
+    if (!score_nan && ((!id_null && i < 5000) || (!tag_null && i % 3 == 2))) {
+      expect += 1;
+    }
+    if (score_null || id_null) {
+      expect_nulls += 1;
+    }
+  }
+
+  CpDataFrame *q1 =
+      cp_df_query(df, "score != nan and (id < 5000 or tag == 'c')", &err);
+  CHECK(q1 != NULL);
+  if (q1) {
+    CHECK(cp_df_nrows(q1) == expect);
+    cp_df_free(q1);
+  }
+  CpDataFrame *q2 = cp_df_query(df, "score == null or id == null", &err);
+  CHECK(q2 != NULL);
+  if (q2) {
+    CHECK(cp_df_nrows(q2) == expect_nulls);
+    cp_df_free(q2);
+  }
+  cp_df_free(df);
+}
+
+static void test_row_view(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "city", "val"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_STRING, CP_DTYPE_FLOAT64};
+  CpDataFrame *df = cp_df_create(3, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  const char *cities[] = {"Oslo", "Lima", "Pune", ""};
+  for (int i = 0; i < 1000; ++i) {
+    char id[16];
+    char val[32];
+    snprintf(id, sizeof(id), "%d", i);
+    snprintf(val, sizeof(val), "%d.25", (i * 37) % 50);
+    const char *row[3] = {id, cities[(i * 7) % 4], i % 11 == 0 ? "" : val};
+    CHECK(cp_df_append_row(df, row, 3, &err));
+  }
+
+  CpRowView *all = cp_df_rows_view(df, &err);
+  CpRowView *v1 = cp_row_view_filter_int64(all, "id", CP_OP_GE, 100, &err);
+  CpRowView *v2 = cp_row_view_query(v1, "val > 10", &err);
+  CpRowView *v3 = cp_row_view_dropna(v2, &err);
+  CHECK(all && v1 && v2 && v3);
+  CHECK(cp_row_view_nrows(all) == 1000);
+  CHECK(cp_row_view_nrows(v1) == 900);
+  CHECK(cp_row_view_base(v3) == df);
+
+  CpDataFrame *f1 = cp_df_filter_int64(df, "id", CP_OP_GE, 100, &err);
+  CpDataFrame *f2 = f1 ? cp_df_query(f1, "val > 10", &err) : NULL;
+  CpDataFrame *f3 = f2 ? cp_df_dropna(f2, &err) : NULL;
+  CHECK(f3 != NULL);
+
+  CpDataFrame *m3 = cp_df_materialize(v3, &err);
+  CHECK(m3 != NULL);
+  if (m3 && f3) {
+    CHECK(csv_frames_match(m3, f3, names, 3));
+  }
+
+  const char *values[] = {"val", "val"};
+  CpAggOp ops[] = {CP_AGG_SUM, CP_AGG_COUNT};
+  const char *out_names[] = {"city", "val_sum", "val_count"};
+  CpDataFrame *g_view = cp_row_view_groupby_agg(v2, "city", values, ops, 2,
+                                                &err);
+  CpDataFrame *g_copy = f2 ? cp_df_groupby_agg(f2, "city", values, ops, 2,
+                                               &err)
+                           : NULL;
+  CHECK(g_view != NULL && g_copy != NULL);
+  if (g_view && g_copy) {
+    CHECK(cp_df_nrows(g_view) == 3);
+    CHECK(csv_frames_match(g_view, g_copy, out_names, 3));
+  }
+
+  uint8_t mask[3] = {1, 0, 1};
+  size_t picks[] = {5, 0, 2};
+  CpRowView *taken = v3 ? cp_row_view_take(v3, picks, 3, &err) : NULL;
+  CpRowView *masked =
+      taken ? cp_row_view_filter_mask(taken, mask, 3, &err) : NULL;
+  CHECK(masked != NULL);
+  if (masked && v3) {
+    CHECK(cp_row_view_nrows(masked) == 2);
+    CHECK(cp_row_view_rows(masked)[0] == cp_row_view_rows(v3)[5]);
+    CHECK(cp_row_view_rows(masked)[1] == cp_row_view_rows(v3)[2]);
+  }
+
+  cp_error_clear(&err);
+  size_t bad_pick[] = {100000};
+  CHECK(cp_row_view_take(v3, bad_pick, 1, &err) == NULL);
+  CHECK(err.code == CP_ERR_INVALID);
+  cp_error_clear(&err);
+  CHECK(cp_row_view_filter_mask(v3, mask, 3, &err) == NULL);
+  CHECK(err.code == CP_ERR_INVALID);
+
+  cp_row_view_free(masked);
+  cp_row_view_free(taken);
+  cp_df_free(g_view);
+  cp_df_free(g_copy);
+  cp_df_free(m3);
+  cp_df_free(f3);
+  cp_df_free(f2);
+  cp_df_free(f1);
+  cp_row_view_free(v3);
+  cp_row_view_free(v2);
+  cp_row_view_free(v1);
+  cp_row_view_free(all);
+  cp_df_free(df);
+}
+
+static void test_lazy_plan(void) {
+  CpError err;
+  cp_error_clear(&err);
+
+  const char *names[] = {"id", "city", "val", "qty"};
+  CpDType dtypes[] = {CP_DTYPE_INT64, CP_DTYPE_STRING, CP_DTYPE_FLOAT64,
+                      CP_DTYPE_INT64};
+  CpDataFrame *df = cp_df_create(4, names, dtypes, 0, &err);
+  CHECK(df != NULL);
+  if (!df) {
+    return;
+  }
+  const char *cities[] = {"Oslo", "Lima", "Pune"};
+  for (int i = 0; i < 500; ++i) {
+    char id[16];
+    char val[32];
+    char qty[16];
+    snprintf(id, sizeof(id), "%d", i);
+    snprintf(val, sizeof(val), "%d.5", (i * 13) % 40);
+    snprintf(qty, sizeof(qty), "%d", (i * 7) % 10);
+    const char *row[4] = {id, cities[i % 3], i % 17 == 0 ? "" : val, qty};
+    CHECK(cp_df_append_row(df, row, 4, &err));
+  }
+  char *path = make_temp_path();
+  CHECK(path != NULL);
+  if (!path) {
+    cp_df_free(df);
+    return;
+  }
+  CHECK(cp_df_write_parquet(df, path, &err));
+
+  CpLazyFrame *lf = cp_lazy_scan_parquet(path, &err);
+  lf = cp_lazy_filter(lf, "id >= 100", &err);
+  lf = cp_lazy_arith_scalar(lf, "val", CP_ARITH_MUL, 2.0, "val2", &err);
+  lf = cp_lazy_arith_scalar(lf, "val2", CP_ARITH_ADD, 1.0, NULL, &err);
+  lf = cp_lazy_filter(lf, "qty < 5", &err);
+  const char *keep[] = {"val2"};
+  lf = cp_lazy_select(lf, keep, 1, &err);
+  CHECK(lf != NULL);
+  char *plan = lf ? cp_lazy_explain(lf, &err) : NULL;
+  CHECK(plan != NULL);
+  if (plan) {
+    CHECK(strstr(plan, "FILTER") == NULL);
+    CHECK(strstr(plan, "WITH_COLUMN val2 = val * 2 + 1\n") != NULL);
+    CHECK(strstr(plan, "columns=[val, id, qty]") != NULL);
+    CHECK(strstr(plan, "predicate=(id >= 100) and (qty < 5)") != NULL);
+  }
+  free(plan);
+  CpDataFrame *lazy_out = lf ? cp_lazy_collect(lf, &err) : NULL;
+  CHECK(lazy_out != NULL);
+
+  CpDataFrame *filtered = cp_df_query(df, "id >= 100 and qty < 5", &err);
+  CpDataFrame *scaled =
+      filtered ? cp_df_arith_scalar(filtered, "val", CP_ARITH_MUL, 2.0, "val2",
+                                    &err)
+               : NULL;
+  CpDataFrame *expected =
+      scaled ? cp_df_arith_scalar(scaled, "val2", CP_ARITH_ADD, 1.0, NULL, &err)
+             : NULL;
+  CHECK(expected != NULL);
+  if (lazy_out && expected) {
+    CHECK(cp_df_nrows(lazy_out) == cp_df_nrows(filtered));
+    CHECK(csv_frames_match(lazy_out, expected, keep, 1));
+  }
+
+  CpLazyFrame *grouped = cp_lazy_from_df(df, &err);
+  const char *keys[] = {"city"};
+  const char *values[] = {"val", "qty"};
+  CpAggOp ops[] = {CP_AGG_SUM, CP_AGG_MAX};
+  grouped = cp_lazy_filter(grouped, "qty > 2", &err);
+  grouped = cp_lazy_groupby_agg(grouped, keys, 1, values, ops, 2, &err);
+  grouped = cp_lazy_filter(grouped, "city != Lima", &err);
+  char *grouped_plan = grouped ? cp_lazy_explain(grouped, &err) : NULL;
+  CHECK(grouped_plan != NULL);
+  if (grouped_plan) {
+    CHECK(strncmp(grouped_plan, "GROUPBY [city]", 14) == 0);
+    CHECK(strstr(grouped_plan, "FILTER (qty > 2) and (city != Lima)") != NULL);
+  }
+  free(grouped_plan);
+  CpDataFrame *lazy_groups = grouped ? cp_lazy_collect(grouped, &err) : NULL;
+  CpDataFrame *query_groups =
+      cp_df_query(df, "qty > 2 and city != Lima", &err);
+  CpDataFrame *eager_groups =
+      query_groups ? cp_df_groupby_agg(query_groups, "city", values, ops, 2,
+                                       &err)
+                   : NULL;
+  const char *group_names[] = {"city", "val_sum", "qty_max"};
+  CHECK(lazy_groups != NULL && eager_groups != NULL);
+  if (lazy_groups && eager_groups) {
+    CHECK(cp_df_nrows(lazy_groups) == 2);
+    CHECK(csv_frames_match(lazy_groups, eager_groups, group_names, 3));
+  }
+
+  const char *lookup_names[] = {"city", "region"};
+  CpDType lookup_dtypes[] = {CP_DTYPE_STRING, CP_DTYPE_STRING};
+  CpDataFrame *lookup = cp_df_create(2, lookup_names, lookup_dtypes, 0, &err);
+  const char *lookup_rows[][2] = {{"Oslo", "EU"}, {"Pune", "AS"}};
+  for (size_t i = 0; lookup && i < 2; ++i) {
+    CHECK(cp_df_append_row(lookup, lookup_rows[i], 2, &err));
+  }
+  CpLazyFrame *joined = cp_lazy_scan_parquet(path, &err);
+  joined = cp_lazy_filter(joined, "id < 20", &err);
+  joined = cp_lazy_join(joined, cp_lazy_from_df(lookup, &err), keys, keys, 1,
+                        CP_JOIN_INNER, NULL, NULL, &err);
+  const char *join_cols[] = {"id", "region"};
+  joined = cp_lazy_select(joined, join_cols, 2, &err);
+  CpDataFrame *lazy_join = joined ? cp_lazy_collect(joined, &err) : NULL;
+  CpDataFrame *head = cp_df_query(df, "id < 20", &err);
+  CpDataFrame *eager_join =
+      head && lookup ? cp_df_join_multi(head, lookup, keys, keys, 1,
+                                        CP_JOIN_INNER, NULL, NULL, &err)
+                     : NULL;
+  CpDataFrame *eager_cols =
+      eager_join ? cp_df_select_cols(eager_join, join_cols, 2, &err) : NULL;
+  CHECK(lazy_join != NULL && eager_cols != NULL);
+  if (lazy_join && eager_cols) {
+    CHECK(cp_df_nrows(lazy_join) == 13);
+    CHECK(csv_frames_match(lazy_join, eager_cols, join_cols, 2));
+  }
+
+  cp_error_clear(&err);
+  CHECK(cp_lazy_filter(cp_lazy_from_df(df, &err), "> 3", &err) == NULL);
+  CHECK(err.code == CP_ERR_INVALID);
+  cp_error_clear(&err);
+  CpLazyFrame *missing = cp_lazy_scan_csv("/nonexistent/cpandas.csv", ',', 1,
+                                          NULL, 0, &err);
+  CHECK(missing != NULL);
+  CHECK(missing && cp_lazy_collect(missing, &err) == NULL);
+  CHECK(err.code == CP_ERR_IO);
+
+  cp_lazy_free(missing);
+  cp_df_free(eager_cols);
+  cp_df_free(eager_join);
+  cp_df_free(head);
+  cp_df_free(lazy_join);
+  cp_lazy_free(joined);
+  cp_df_free(lookup);
+  cp_df_free(eager_groups);
+  cp_df_free(query_groups);
+  cp_df_free(lazy_groups);
+  cp_lazy_free(grouped);
+  cp_df_free(expected);
+  cp_df_free(scaled);
+  cp_df_free(filtered);
+  cp_df_free(lazy_out);
+  cp_lazy_free(lf);
+  remove(path);
+  free(path);
+  cp_df_free(df);
+}
+
 int main(void) {
   test_read_csv_header();
   test_read_csv_no_header();
@@ -5926,10 +9016,21 @@ int main(void) {
   test_parquet_delta_encoding();
   test_parquet_nested_struct();
   test_parquet_list_map();
+  test_parquet_read_ex();
+  test_parquet_parallel_decode();
+  test_parquet_writer();
+  test_cpd_mmap();
+  test_reader_batches();
   test_plot();
   test_write_csv_header();
+  test_text_writers_round_trip();
   test_append_row_errors();
   test_read_csv_mismatch();
+  test_read_csv_blocks();
+  test_read_csv_parallel();
+  test_string_arena_sharing();
+  test_category_dtype();
+  test_null_bitmap();
   test_aggregations();
   test_dense_float_aggregations();
   test_df_aggregation_helpers();
@@ -5941,6 +9042,7 @@ int main(void) {
   test_zero_copy_dtype_and_drop_views();
   test_sort_values();
   test_sort_values_multi();
+  test_sort_radix();
   test_head_tail();
   test_metadata_helpers();
   test_dtypes_and_rename_drop_fill();
@@ -5954,29 +9056,49 @@ int main(void) {
   test_unique_counts_string();
   test_sample();
   test_nlargest_nsmallest();
+  test_nlargest_keep();
   test_where_mask_clip_replace();
   test_concat();
   test_apply_transform_iter();
+  test_apply_transform_batch();
   test_astype_index_at();
   test_conversion_helpers();
   test_stats_helpers();
   test_corr_cov();
   test_isnull_dropna();
   test_info_describe();
+  test_series_quantile();
   test_loc_iloc();
   test_loc_labels_slice();
   test_multi_index_loc();
+  test_row_index_lookup();
   test_groupby_agg();
+  test_groupby_agg_many_groups();
+  test_groupby_agg_multi();
+  test_groupby_agg_large();
+  test_groupby_agg_merge_overflow();
+  test_groupby_state_stream();
   test_join_inner_left();
   test_join_multi_key();
   test_join_hash_path();
   test_join_strategy_forced();
+  test_join_partitioned();
+  test_join_asof();
   test_pivot_table();
   test_pivot_table_multi();
   test_resample();
+  test_rolling_windows();
   test_predicate_filters();
   test_vector_ops();
   test_query();
+  test_query_batches();
+  test_row_view();
+  test_lazy_plan();
+  test_simd_dispatch();
+  test_allocator_hooks();
+  test_memory_usage();
+  test_memory_usage_shared_arena();
+  test_trace_callback();
 
   if (tests_failed != 0) {
     fprintf(stderr, "%d test(s) failed\n", tests_failed);